@@ -0,0 +1,217 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "areas.h"
+#include "ballistics.h"
+
+// Funo que calcula o maior nmero de colunas e de linhas que a grade pode ter: as clulas tm
+// lado de pelo menos sqrt(width * height / n), ento cabem no mximo sqrt(n width / height) colunas
+static void max_size(int n, float width, float height, int* cols, int* rows) {
+	*cols = (int)ceil(sqrt((double)n * width / height)) + 1;
+	*rows = (int)ceil(sqrt((double)n * height / width)) + 1;
+}
+
+size_t area_index_arena_bytes(int num_areas, float width, float height) {
+	int cols, rows;
+
+	max_size(num_areas, width, height, &cols, &rows);
+	return ARENA_BYTES(((size_t)cols * rows + 1) * sizeof(int), sizeof(int))
+		+ ARENA_BYTES(4 * (size_t)num_areas * sizeof(int), sizeof(int));
+}
+
+int area_index_create(struct AreaIndex* idx, int num_areas, float width, float height, struct Arena* arena) {
+	max_size(num_areas, width, height, &idx->max_cols, &idx->max_rows);
+	idx->cols = 0;
+	idx->rows = 0;
+	idx->start = arena_alloc(arena, ((size_t)idx->max_cols * idx->max_rows + 1) * sizeof(int), sizeof(int));
+	idx->items = arena_alloc(arena, 4 * (size_t)num_areas * sizeof(int), sizeof(int));
+
+	return idx->start == NULL || idx->items == NULL ? -1 : 0;
+}
+
+// Funes que calculam a coluna e a linha de uma coordenada; o que fica fora da janela vai para a borda
+static int column(const struct AreaIndex* idx, double x) {
+	double c = floor(x / idx->cell_width);
+	return c < 0 ? 0 : (c >= idx->cols ? idx->cols - 1 : (int)c);
+}
+
+static int row(const struct AreaIndex* idx, double y) {
+	double r = floor(y / idx->cell_height);
+	return r < 0 ? 0 : (r >= idx->rows ? idx->rows - 1 : (int)r);
+}
+
+// Funo que calcula o retngulo de clulas tocado por uma rea, com a folga das bordas
+static void area_cells(const struct AreaIndex* idx, const struct Area* a, int* c0, int* r0, int* c1, int* r1) {
+	*c0 = column(idx, a->x - BALLISTIC_EDGE_EPS);
+	*c1 = column(idx, a->x + a->width + BALLISTIC_EDGE_EPS);
+	*r0 = row(idx, a->y - BALLISTIC_EDGE_EPS);
+	*r1 = row(idx, a->y + a->height + BALLISTIC_EDGE_EPS);
+}
+
+void area_index_build(struct AreaIndex* idx, const struct Area* areas, int n, float width, float height) {
+	float largest = 0;
+	float size = sqrtf(width * height / (n > 0 ? n : 1));
+	int cells, c0, r0, c1, r1;
+
+	// O lado das clulas  o maior entre o que d cerca de uma clula por rea e o da maior rea
+	// (com as folgas), para que nenhuma rea ocupe mais do que 2 x 2 clulas
+	for (int a = 0; a < n; a++) {
+		largest = areas[a].width > largest ? areas[a].width : largest;
+		largest = areas[a].height > largest ? areas[a].height : largest;
+	}
+	largest += (float)(2 * BALLISTIC_EDGE_EPS);
+	size = size > largest ? size : largest;
+
+	idx->cols = (int)(width / size);
+	idx->rows = (int)(height / size);
+	idx->cols = idx->cols < 1 ? 1 : (idx->cols > idx->max_cols ? idx->max_cols : idx->cols);
+	idx->rows = idx->rows < 1 ? 1 : (idx->rows > idx->max_rows ? idx->max_rows : idx->rows);
+	idx->cell_width = width / idx->cols;
+	idx->cell_height = height / idx->rows;
+	cells = idx->cols * idx->rows;
+
+	// Conta as reas de cada clula e acumula as contagens at o fim da lista de cada uma
+	memset(idx->start, 0, ((size_t)cells + 1) * sizeof(int));
+	for (int a = 0; a < n; a++) {
+		area_cells(idx, &areas[a], &c0, &r0, &c1, &r1);
+		for (int r = r0; r <= r1; r++) {
+			for (int c = c0; c <= c1; c++) {
+				idx->start[r * idx->cols + c]++;
+			}
+		}
+	}
+	for (int c = 1; c <= cells; c++) {
+		idx->start[c] += idx->start[c - 1];
+	}
+
+	// Preenche as listas de trs para frente, ento cada uma fica em ordem crescente e start[c]
+	// termina apontando para o seu incio
+	for (int a = n - 1; a >= 0; a--) {
+		area_cells(idx, &areas[a], &c0, &r0, &c1, &r1);
+		for (int r = r0; r <= r1; r++) {
+			for (int c = c0; c <= c1; c++) {
+				idx->items[--idx->start[r * idx->cols + c]] = a;
+			}
+		}
+	}
+}
+
+int area_index_find(const struct AreaIndex* idx, const struct Area* areas, float x, float y) {
+	int c = row(idx, y) * idx->cols + column(idx, x);
+
+	for (int k = idx->start[c]; k < idx->start[c + 1]; k++) {
+		const struct Area* a = &areas[idx->items[k]];
+
+		if (x >= a->x && x <= a->x + a->width && y >= a->y && y <= a->y + a->height) {
+			return idx->items[k];
+		}
+	}
+	return -1;
+}
+
+// Funo que testa as reas das linhas r0 a r1 de uma coluna contra a trajetria
+static void visit_column(const struct AreaIndex* idx, const struct Area* areas, int c, int r0, int r1,
+	float x, float y, float vx, float vy, float gravity, double* best, int* found) {
+	for (int r = r0; r <= r1; r++) {
+		int cell = r * idx->cols + c;
+
+		for (int k = idx->start[cell]; k < idx->start[cell + 1]; k++) {
+			int j = idx->items[k];
+			const struct Area* a = &areas[j];
+			double t = ballistic_rect_entry(x, y, vx, vy, gravity, a->x, a->y, a->width, a->height, *best);
+
+			// No empate fica a de menor ndice (uma rea de 2 x 2 clulas pode ser vista de novo)
+			if (t < *best || (t == *best && *found >= 0 && j < *found)) {
+				*best = t;
+				*found = j;
+			}
+		}
+	}
+}
+
+int area_index_trajectory(const struct AreaIndex* idx, const struct Area* areas, float x, float y, float vx, float vy,
+	float gravity, double* end) {
+	const double eps = BALLISTIC_EDGE_EPS;
+	double best = *end;
+	int found = -1;
+	int dir = vx > 0 ? 1 : (vx < 0 ? -1 : 0);
+	int c = column(idx, dir < 0 ? x + eps : x - eps);
+	int last = dir != 0 ? (dir > 0 ? idx->cols - 1 : 0) : column(idx, x + eps);
+
+	// Percorre as colunas na ordem em que a trajetria passa por elas (com vx = 0, s as da posio)
+	for (;; c += dir != 0 ? dir : 1) {
+		double t0 = 0, t1 = best;
+		double ya, yb, lo, hi;
+
+		if (dir != 0) {
+			// Intervalo de tempo em que x est na coluna (com as folgas); as colunas da borda vo at o infinito
+			double left = c == 0 ? -HUGE_VAL : c * (double)idx->cell_width - eps;
+			double right = c == idx->cols - 1 ? HUGE_VAL : (c + 1) * (double)idx->cell_width + eps;
+			double ta = ((dir > 0 ? left : right) - x) / vx;
+			double tb = ((dir > 0 ? right : left) - x) / vx;
+
+			t0 = ta > 0 ? ta : 0;
+			t1 = tb < best ? tb : best;
+		}
+		if (t0 > best) {
+			break;
+		}
+
+		// Faixa de y percorrida no intervalo: os extremos e o pice, se ele cai dentro
+		ya = y + vy * t0 + 0.5 * gravity * t0 * t0;
+		yb = y + vy * t1 + 0.5 * gravity * t1 * t1;
+		lo = ya < yb ? ya : yb;
+		hi = ya < yb ? yb : ya;
+		if (gravity != 0) {
+			double apex = -vy / (double)gravity;
+
+			if (apex > t0 && apex < t1) {
+				double ym = y + vy * apex + 0.5 * gravity * apex * apex;
+				lo = ym < lo ? ym : lo;
+				hi = ym > hi ? ym : hi;
+			}
+		}
+		if (t0 <= t1) {
+			visit_column(idx, areas, c, row(idx, lo - eps), row(idx, hi + eps), x, y, vx, vy, gravity, &best, &found);
+		}
+
+		if (c == last) {
+			break;
+		}
+	}
+
+	if (found >= 0) {
+		*end = best;
+	}
+	return found;
+}
+
+int areas_load(FILE* f, struct Area* areas, int capacity) {
+	char line[256];
+	int n = 0;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		const char* p = line + strspn(line, " \t\r\n");
+		struct Area a;
+
+		if (*p == '\0' || *p == '#') {
+			continue;
+		}
+		if (sscanf(p, "%f %f %f %f", &a.x, &a.y, &a.width, &a.height) != 4 || n == capacity) {
+			return -1;
+		}
+
+		// Rejeita valores que no so finitos (a grade do ndice converteria NaN em coluna) e reas vazias
+		if (!isfinite(a.x) || !isfinite(a.y) || !isfinite(a.width) || !isfinite(a.height) || a.width <= 0 || a.height <= 0) {
+			return -1;
+		}
+		if (areas != NULL) {
+			a.hit = 0;
+			a.value = a.width * a.height / AREA_VALUE_UNIT;
+			areas[n] = a;
+		}
+		n++;
+	}
+	return n;
+}
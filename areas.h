@@ -0,0 +1,61 @@
+#ifndef AREAS_H
+#define AREAS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "arena.h"
+
+#define AREA_VALUE_UNIT 100.0f // Superfcie (unidades) que vale 1 no valor de uma rea
+
+// rea habitada
+struct Area {
+	float x; // Posio x da rea
+	float y; // Posio y da rea
+	float width; // Largura da rea
+	float height; // Altura da rea
+	int hit; // Indica se a rea foi atingida por um mssil ou no
+	float value; // Valor da rea para a defesa (proporcional  superfcie, como a populao)
+};
+
+// ndice espacial esttico das reas habitadas: uma grade uniforme sobre a janela, montada uma
+// vez em init(), em que cada clula lista (em ordem crescente) as reas que a tocam. As clulas
+// so pelo menos do tamanho da maior rea, ento cada rea aparece em no mximo 2 x 2 clulas,
+// e h cerca de uma clula por rea, ento cada clula tem em mdia poucas reas.
+struct AreaIndex {
+	int max_cols; // Nmero mximo de colunas (reservado por area_index_create)
+	int max_rows; // Nmero mximo de linhas
+	int cols; // Nmero de colunas
+	int rows; // Nmero de linhas
+	float cell_width; // Largura das clulas
+	float cell_height; // Altura das clulas
+	int* start; // Incio da lista de cada clula em items (cols * rows + 1 posies)
+	int* items; // ndices das reas, clula aps clula
+};
+
+// Calcula quantos bytes de arena area_index_create usa para num_areas reas numa janela width x height
+size_t area_index_arena_bytes(int num_areas, float width, float height);
+
+// Reserva na arena a memria do ndice. Retorna 0 se conseguiu.
+int area_index_create(struct AreaIndex* idx, int num_areas, float width, float height, struct Arena* arena);
+
+// Monta o ndice das n reas (no mximo as num_areas de area_index_create)
+void area_index_build(struct AreaIndex* idx, const struct Area* areas, int n, float width, float height);
+
+// Retorna a rea de menor ndice que contm o ponto (x, y), ou -1 se nenhuma
+int area_index_find(const struct AreaIndex* idx, const struct Area* areas, float x, float y);
+
+// Procura a primeira rea atingida pela trajetria parablica que parte de (x, y) com velocidade
+// (vx, vy) antes do instante *end (em caso de empate fica a de menor ndice). Se encontrar,
+// guarda em *end o instante da entrada nela e retorna o seu ndice; seno retorna -1. S visita
+// as clulas por onde a trajetria passa, na ordem do tempo, e para na primeira rea encontrada.
+int area_index_trajectory(const struct AreaIndex* idx, const struct Area* areas, float x, float y, float vx, float vy,
+	float gravity, double* end);
+
+// L reas de um arquivo de texto com uma rea por linha ("x y largura altura"; linhas vazias
+// ou comeadas por '#' so ignoradas). Com areas NULL apenas conta. Retorna o nmero de reas,
+// ou -1 se uma linha  invlida (valores no finitos ou largura ou altura no positivas) ou h
+// mais de capacity reas.
+int areas_load(FILE* f, struct Area* areas, int capacity);
+
+#endif
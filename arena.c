@@ -0,0 +1,24 @@
+#include "arena.h"
+
+void arena_init(struct Arena* a, void* buffer, size_t size) {
+	a->base = (uint8_t*)buffer;
+	a->size = size;
+	a->used = 0;
+}
+
+void* arena_alloc(struct Arena* a, size_t size, size_t align) {
+	// Alinha o endereo, e no apenas o deslocamento, porque o buffer pode no estar alinhado
+	uintptr_t start = ARENA_ALIGN_UP((uintptr_t)(a->base + a->used), (uintptr_t)align);
+	size_t offset = (size_t)(start - (uintptr_t)a->base);
+
+	if (a->base == NULL || offset > a->size || size > a->size - offset) {
+		return NULL;
+	}
+
+	a->used = offset + size;
+	return (void*)start;
+}
+
+void arena_reset(struct Arena* a) {
+	a->used = 0;
+}
@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Arredonda n para cima at um mltiplo de align
+#define ARENA_ALIGN_UP(n, align) (((n) + (align) - 1) / (align) * (align))
+
+// Nmero de bytes que uma reserva de size bytes alinhada em align pode ocupar na arena
+#define ARENA_BYTES(size, align) ((size_t)(size) + (align))
+
+// Regio de memria da qual a simulao retira todos os seus vetores uma nica vez, na
+// inicializao. No h liberao individual: quem precisa de memria nova reinicia a arena.
+struct Arena {
+	uint8_t* base; // Incio da regio
+	size_t size; // Tamanho da regio em bytes
+	size_t used; // Bytes j reservados
+};
+
+// Inicializa uma arena vazia sobre buffer
+void arena_init(struct Arena* a, void* buffer, size_t size);
+
+// Reserva size bytes alinhados em align (potncia de 2). Retorna NULL se no houver espao.
+void* arena_alloc(struct Arena* a, size_t size, size_t align);
+
+// Descarta todas as reservas
+void arena_reset(struct Arena* a);
+
+#endif
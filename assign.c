@@ -0,0 +1,369 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assign.h"
+#include "stats.h"
+
+size_t assign_arena_bytes(const struct SimConfig* config) {
+	size_t n = config->ring_capacity;
+	size_t pairs = (size_t)config->num_launchers * n;
+	size_t slots = (size_t)config->interceptors_per_defense;
+
+	return 2 * ARENA_BYTES(n * sizeof(struct LaunchDescriptor), sizeof(double))
+		+ ARENA_BYTES(pairs * sizeof(float), sizeof(float))
+		+ ARENA_BYTES(pairs * sizeof(struct AssignPair), sizeof(float))
+		+ 3 * ARENA_BYTES(slots * sizeof(int), sizeof(int))
+		+ ARENA_BYTES(n * sizeof(int), sizeof(int))
+		+ ARENA_BYTES(n * sizeof(float), sizeof(float));
+}
+
+int assign_create(struct Assignment* a, const struct SimConfig* config, struct Arena* arena) {
+	size_t n = config->ring_capacity;
+	size_t pairs = (size_t)config->num_launchers * n;
+	size_t slots = (size_t)config->interceptors_per_defense;
+
+	a->capacity = (int)n;
+	a->launchers = config->num_launchers;
+	a->slots = config->interceptors_per_defense;
+	a->heap = arena_alloc(arena, n * sizeof(struct LaunchDescriptor), sizeof(double));
+	a->threats = arena_alloc(arena, n * sizeof(struct LaunchDescriptor), sizeof(double));
+	a->score = arena_alloc(arena, pairs * sizeof(float), sizeof(float));
+	a->pairs = arena_alloc(arena, pairs * sizeof(struct AssignPair), sizeof(float));
+	a->slot_threat = arena_alloc(arena, slots * sizeof(int), sizeof(int));
+	a->greedy_threat = arena_alloc(arena, slots * sizeof(int), sizeof(int));
+	a->queue = arena_alloc(arena, slots * sizeof(int), sizeof(int));
+	a->threat_slot = arena_alloc(arena, n * sizeof(int), sizeof(int));
+	a->price = arena_alloc(arena, n * sizeof(float), sizeof(float));
+
+	if (a->heap == NULL || a->threats == NULL || a->score == NULL || a->pairs == NULL || a->slot_threat == NULL || a->greedy_threat == NULL
+		|| a->queue == NULL || a->threat_slot == NULL || a->price == NULL) {
+		return -1;
+	}
+	assign_reset(a);
+	return 0;
+}
+
+void assign_reset(struct Assignment* a) {
+	a->pending = 0;
+	a->size = 0;
+	a->next_salvo = 0;
+	a->auction_runs = 0;
+	a->auction_timeouts = 0;
+}
+
+// Funo que indica se a ameaa a atinge o alvo antes da ameaa b (no empate, a mais antiga)
+static int threat_before(const struct LaunchDescriptor* a, const struct LaunchDescriptor* b) {
+	if (a->impact_time != b->impact_time) {
+		return a->impact_time < b->impact_time;
+	}
+	return a->id < b->id;
+}
+
+// Funo que acrescenta uma ameaa ao acmulo, subindo-a at a sua posio no heap
+static void heap_push(struct Assignment* a, const struct LaunchDescriptor* threat) {
+	int k = a->pending++;
+
+	while (k > 0 && threat_before(threat, &a->heap[(k - 1) / 2])) {
+		a->heap[k] = a->heap[(k - 1) / 2];
+		k = (k - 1) / 2;
+	}
+	a->heap[k] = *threat;
+}
+
+// Funo que retira a ameaa mais urgente do acmulo e a copia em out, se out no for NULL
+static void heap_pop(struct Assignment* a, struct LaunchDescriptor* out) {
+	struct LaunchDescriptor last = a->heap[--a->pending];
+	int k = 0;
+
+	if (out != NULL) {
+		*out = a->heap[0];
+	}
+
+	// A ltima ameaa ocupa o topo e desce at a sua posio
+	for (;;) {
+		int c = 2 * k + 1;
+
+		if (c >= a->pending) {
+			break;
+		}
+		if (c + 1 < a->pending && threat_before(&a->heap[c + 1], &a->heap[c])) {
+			c++;
+		}
+		if (!threat_before(&a->heap[c], &last)) {
+			break;
+		}
+		a->heap[k] = a->heap[c];
+		k = c;
+	}
+	if (a->pending > 0) {
+		a->heap[k] = last;
+	}
+}
+
+int assign_add_threat(struct Assignment* a, const struct LaunchDescriptor* threat) {
+	if (a->pending == a->capacity) {
+		return 0;
+	}
+
+	// S vale a pena gastar interceptores com msseis direcionados a uma rea habitada
+	if (threat->targeted) {
+		heap_push(a, threat);
+	}
+	return 1;
+}
+
+double assign_next_wake(const struct Assignment* a, double now) {
+	if (a->pending == 0) {
+		// S uma nova ameaa pode exigir outra salva
+		return HUGE_VAL;
+	}
+	if (a->next_salvo > now) {
+		return a->next_salvo;
+	}
+
+	// A salva estava liberada e sobraram ameaas, ento nenhum lanador as alcana por enquanto
+	return now + ASSIGN_RETRY_INTERVAL;
+}
+
+// Funo que pontua os pares (lanador, ameaa j). Um par invivel recebe -1; os viveis
+// valem o valor da rea ameaada, aumentado pela folga entre o encontro e o impacto (um
+// interceptor que chega cedo deixa margem para uma segunda tentativa) e pela urgncia (uma
+// ameaa que atinge a rea antes da prxima salva no ter outra chance). Retorna a maior
+// pontuao da ameaa, ou -1 se nenhum lanador a alcana.
+static float score_threat(struct Simulation* sim, struct Assignment* a, int j, double now) {
+	const float period = DEFENSE_INTERVAL / 1000.0f;
+	const struct LaunchDescriptor* threat = &a->threats[j];
+	float time_to_impact = (float)(threat->impact_time - now);
+	float best = -1;
+
+	for (int l = 0; l < a->launchers; l++) {
+		float* score = &a->score[(size_t)l * a->capacity + j];
+		float angle, speed, vx, vy, flight;
+
+		if (!calculate_intercept(sim, threat, now, l, &angle, &speed, &vx, &vy, &flight)) {
+			*score = -1;
+			continue;
+		}
+		*score = sim->areas[threat->impact_area].value * (2 - flight / time_to_impact)
+			* (1 + period / (period + time_to_impact));
+		best = *score > best ? *score : best;
+	}
+	return best;
+}
+
+// Funo que compara dois pares pela pontuao decrescente e, no empate, pelo ndice
+static int compare_pairs(const void* p, const void* q) {
+	const struct AssignPair* a = p;
+	const struct AssignPair* b = q;
+
+	if (a->score != b->score) {
+		return a->score > b->score ? -1 : 1;
+	}
+	return (a->index > b->index) - (a->index < b->index);
+}
+
+// Funo que atribui os pares em ordem decrescente de pontuao enquanto a ameaa e algum
+// interceptor do lanador estiverem livres. Com um s lanador os interceptores so
+// equivalentes e a soluo gulosa j  tima.
+static void assign_greedy(struct Assignment* a) {
+	int next_slot[MAX_LAUNCHERS];
+	int n = 0;
+
+	for (int l = 0; l < a->launchers; l++) {
+		const float* row = a->score + (size_t)l * a->capacity;
+
+		next_slot[l] = l;
+		for (int j = 0; j < a->size; j++) {
+			if (row[j] >= 0) {
+				a->pairs[n].score = row[j];
+				a->pairs[n].index = l * a->capacity + j;
+				n++;
+			}
+		}
+	}
+	qsort(a->pairs, (size_t)n, sizeof(struct AssignPair), compare_pairs);
+
+	for (int k = 0; k < n; k++) {
+		int l = a->pairs[k].index / a->capacity;
+		int j = a->pairs[k].index % a->capacity;
+
+		if (a->threat_slot[j] < 0 && next_slot[l] < a->slots) {
+			a->threat_slot[j] = next_slot[l];
+			a->slot_threat[next_slot[l]] = j;
+			next_slot[l] += a->launchers;
+		}
+	}
+}
+
+// Funo que soma as pontuaes da atribuio atual
+static float total_score(const struct Assignment* a) {
+	float total = 0;
+
+	for (int s = 0; s < a->slots; s++) {
+		if (a->slot_threat[s] >= 0) {
+			total += a->score[(size_t)(s % a->launchers) * a->capacity + a->slot_threat[s]];
+		}
+	}
+	return total;
+}
+
+// Funo que resolve a atribuio por leilo (Bertsekas): cada interceptor livre d um lance pela
+// ameaa de maior lucro (pontuao menos preo), subindo o preo dela pela diferena para a
+// segunda melhor opo mais epsilon e tomando-a de quem a tinha; desiste quando nenhuma ameaa
+// d lucro. Ao terminar, o total est a no mximo slots * epsilon do timo. Retorna 0 se o
+// oramento de avaliaes acabou antes (a atribuio fica incompleta e no deve ser usada).
+static int assign_auction(struct Assignment* a, float epsilon) {
+	long budget = ASSIGN_AUCTION_BUDGET;
+	int head = 0;
+	int pending = a->slots;
+
+	for (int j = 0; j < a->size; j++) {
+		a->price[j] = 0;
+		a->threat_slot[j] = -1;
+	}
+	for (int s = 0; s < a->slots; s++) {
+		a->slot_threat[s] = -1;
+		a->queue[s] = s;
+	}
+
+	// A fila  circular: cada interceptor livre est nela no mximo uma vez
+	while (pending > 0) {
+		int s = a->queue[head];
+		const float* row = a->score + (size_t)(s % a->launchers) * a->capacity;
+		float first = 0, second = 0;
+		int best = -1;
+
+		head = (head + 1) % a->slots;
+		pending--;
+		budget -= a->size;
+		if (budget < 0) {
+			return 0;
+		}
+
+		// Melhor e segunda melhor opo; no atribuir vale 0
+		for (int j = 0; j < a->size; j++) {
+			float profit = row[j] - a->price[j];
+
+			if (row[j] < 0) {
+				continue;
+			}
+			if (profit > first) {
+				second = first;
+				first = profit;
+				best = j;
+			}
+			else if (profit > second) {
+				second = profit;
+			}
+		}
+		if (best < 0) {
+			continue;
+		}
+
+		// Toma a ameaa do interceptor anterior, que volta para a fila
+		if (a->threat_slot[best] >= 0) {
+			int evicted = a->threat_slot[best];
+
+			a->slot_threat[evicted] = -1;
+			a->queue[(head + pending) % a->slots] = evicted;
+			pending++;
+		}
+		a->price[best] += first - second + epsilon;
+		a->threat_slot[best] = s;
+		a->slot_threat[s] = best;
+	}
+	return 1;
+}
+
+int defense_assign(struct Simulation* sim, struct Assignment* a, double now, struct LaunchDescriptor* out) {
+	float best = 0, greedy;
+	int n = 0, feasible = 0, converged;
+
+	// Descarta as ameaas que j atingiram o alvo (ou saram da janela), que esto no topo do heap
+	while (a->pending > 0 && a->heap[0].impact_time <= now) {
+		heap_pop(a, NULL);
+	}
+	a->size = 0;
+	if (a->pending == 0 || a->slots == 0 || now < a->next_salvo) {
+		return 0;
+	}
+
+	// Retira as ameaas em ordem de urgncia at ter ASSIGN_WINDOW viveis por interceptor ou
+	// esgotar o oramento de pares, para que um acmulo de ameaas inviveis no seja pontuado
+	// inteiro a cada ASSIGN_RETRY_INTERVAL. As inviveis entram na atribuio sem nenhum par e
+	// voltam para o acmulo no fim; as no examinadas nem saem dele.
+	while (a->pending > 0 && feasible < ASSIGN_WINDOW * a->slots
+		&& (long)(a->size + 1) * a->launchers <= ASSIGN_SCORE_BUDGET) {
+		float score;
+
+		heap_pop(a, &a->threats[a->size]);
+		score = score_threat(sim, a, a->size, now);
+		feasible += score >= 0;
+		best = score > best ? score : best;
+		a->size++;
+	}
+
+	for (int j = 0; j < a->size; j++) {
+		a->threat_slot[j] = -1;
+	}
+	for (int s = 0; s < a->slots; s++) {
+		a->slot_threat[s] = -1;
+	}
+	assign_greedy(a);
+
+	// Com mais de um lanador a escolha gulosa pode ocupar o lanador que era o nico capaz de
+	// atingir outra ameaa; o leilo corrige isso se couber no oramento
+	if (a->launchers > 1 && best > 0) {
+		greedy = total_score(a);
+		memcpy(a->greedy_threat, a->slot_threat, (size_t)a->slots * sizeof(int));
+
+		converged = assign_auction(a, best * ASSIGN_AUCTION_EPSILON);
+		if (converged && total_score(a) > greedy) {
+			a->auction_runs++;
+		}
+		else {
+			// O leilo esgotou o oramento ou no melhorou: volta para a soluo gulosa
+			a->auction_timeouts += !converged;
+			memcpy(a->slot_threat, a->greedy_threat, (size_t)a->slots * sizeof(int));
+		}
+
+		// Refaz o ndice inverso a partir da soluo escolhida
+		for (int j = 0; j < a->size; j++) {
+			a->threat_slot[j] = -1;
+		}
+		for (int s = 0; s < a->slots; s++) {
+			if (a->slot_threat[s] >= 0) {
+				a->threat_slot[a->slot_threat[s]] = s;
+			}
+		}
+	}
+
+	// Descreve os interceptores na ordem de urgncia das ameaas e devolve as outras ao acmulo
+	for (int j = 0; j < a->size; j++) {
+		const struct LaunchDescriptor* threat = &a->threats[j];
+		int s = a->threat_slot[j];
+		float angle, speed, vx, vy, flight;
+
+		if (s >= 0) {
+			const struct Launcher* launcher = &sim->launchers[s % a->launchers];
+
+			calculate_intercept(sim, threat, now, s % a->launchers, &angle, &speed, &vx, &vy, &flight);
+			describe_interceptor(sim, &out[n], now, launcher->x, launcher->y, angle, speed, vx, vy);
+			out[n].threat_time = threat->launch_time;
+			n++;
+
+			// Atualiza o nmero de interceptores disparados
+			stats_add(&sim->counters, STATS_DEFENSE, STATS_INTERCEPTORS, 1);
+		}
+		else {
+			heap_push(a, threat);
+		}
+	}
+	a->size = 0;
+
+	if (n > 0) {
+		a->next_salvo = now + DEFENSE_INTERVAL / 1000.0;
+	}
+	return n;
+}
@@ -0,0 +1,74 @@
+#ifndef ASSIGN_H
+#define ASSIGN_H
+
+#include <stddef.h>
+
+#include "arena.h"
+#include "simulation.h"
+
+// Atribuio de interceptores a ameaas. A defesa guarda as ameaas ainda sem resposta num
+// acmulo ordenado pelo instante do impacto (um heap mnimo) e, a cada salva, retira as mais
+// urgentes e pontua cada par (lanador, ameaa) com a viabilidade da interceptao, o tempo at
+// o impacto e o valor da rea protegida. As ameaas expiradas saem pelo topo do heap. Os interceptores da
+// ativao (config.interceptors_per_defense, distribudos entre os lanadores) so atribudos
+// primeiro de forma gulosa e depois por um leilo com oramento fixo de trabalho; o leilo s
+// substitui a soluo gulosa se terminar dentro do oramento com pontuao total maior.
+
+#define ASSIGN_AUCTION_BUDGET 200000 // Avaliaes de pares que o leilo pode fazer por ativao
+#define ASSIGN_AUCTION_EPSILON 1e-3f // Incremento mnimo dos lances, relativo  maior pontuao
+#define ASSIGN_WINDOW 4 // Ameaas viveis consideradas por interceptor da salva, das mais urgentes
+#define ASSIGN_SCORE_BUDGET 200000 // Pares (lanador, ameaa) que uma salva pode pontuar, viveis ou no
+#define ASSIGN_RETRY_INTERVAL 0.1 // Espera em segundos para reavaliar ameaas que nenhum lanador alcana
+
+// Par (lanador, ameaa) com pontuao, ordenado pela atribuio gulosa
+struct AssignPair {
+	float score; // Pontuao do par
+	int index; // lanador * capacity + ameaa
+};
+
+struct Assignment {
+	int capacity; // Nmero mximo de ameaas acumuladas
+	int pending; // Nmero de ameaas acumuladas
+	int size; // Nmero de ameaas retiradas do acmulo para a salva atual
+	int launchers; // Nmero de lanadores
+	int slots; // Interceptores por salva; o interceptor s sai do lanador s % launchers
+	double next_salvo; // Instante a partir do qual a prxima salva pode ser disparada
+	struct LaunchDescriptor* heap; // Ameaas acumuladas, num heap mnimo pelo instante do impacto
+	struct LaunchDescriptor* threats; // Ameaas da salva atual, da mais urgente para a menos urgente
+	float* score; // Pontuao de cada par (launchers x capacity), ou negativa se invivel
+	struct AssignPair* pairs; // Pares viveis da atribuio gulosa
+	int* slot_threat; // Ameaa atribuda a cada interceptor, ou -1
+	int* greedy_threat; // Cpia de slot_threat com a soluo gulosa, enquanto o leilo roda
+	int* threat_slot; // Interceptor atribudo a cada ameaa, ou -1
+	float* price; // Preo de cada ameaa no leilo
+	int* queue; // Interceptores sem ameaa que ainda vo dar lances
+	int auction_runs; // Ativaes em que o leilo melhorou a soluo gulosa
+	int auction_timeouts; // Ativaes em que o leilo esgotou o oramento
+};
+
+// Calcula quantos bytes de arena assign_create usa para uma configurao
+size_t assign_arena_bytes(const struct SimConfig* config);
+
+// Reserva na arena a memria para config.ring_capacity ameaas. Retorna 0 se conseguiu.
+int assign_create(struct Assignment* a, const struct SimConfig* config, struct Arena* arena);
+
+// Esvazia o acmulo de ameaas
+void assign_reset(struct Assignment* a);
+
+// Acrescenta uma ameaa ao acmulo (msseis que no vo atingir reas so ignorados).
+// Retorna 0 se o acmulo est cheio.
+int assign_add_threat(struct Assignment* a, const struct LaunchDescriptor* threat);
+
+// Descarta as ameaas que j atingiram o alvo e, se j passou DEFENSE_INTERVAL desde a ltima
+// salva, atribui os interceptores s ameaas mais urgentes e descreve em out (at
+// config.interceptors_per_defense descritores) os interceptores a lanar, na ordem de urgncia.
+// As ameaas atendidas saem do acmulo; as inviveis ou sem interceptor ficam para a prxima.
+// Retorna o nmero de interceptores descritos.
+int defense_assign(struct Simulation* sim, struct Assignment* a, double now, struct LaunchDescriptor* out);
+
+// Calcula o instante em que a defesa precisa acordar de novo se nenhuma ameaa chegar antes: a
+// prxima salva permitida se h ameaas acumuladas, now + ASSIGN_RETRY_INTERVAL se nenhum
+// lanador as alcana agora, ou HUGE_VAL se o acmulo est vazio
+double assign_next_wake(const struct Assignment* a, double now);
+
+#endif
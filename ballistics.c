@@ -0,0 +1,389 @@
+#include <math.h>
+
+#include "ballistics.h"
+#include "real.h"
+
+#if SIM_FIXED_POINT
+
+// Os valores internos so Q16.16 em 64 bits: posies, velocidades e instantes cabem com folga, e
+// os produtos de dois deles (Q32.32) tambm. Os discriminantes ficam em Q32.32 e a raiz volta a Q16.16.
+
+#define NEVER INT64_MAX // Instante que nunca chega
+
+// Multiplica dois valores, arredondando
+static int64_t mul(int64_t a, int64_t b) {
+	return fx_round_shift(a * b, FX_SHIFT);
+}
+
+// Divide a por b (diferente de 0), truncando
+static int64_t quot(int64_t a, int64_t b) {
+	return a * FX_ONE / b;
+}
+
+static int64_t fx(double v) {
+	return fx_from_double(v);
+}
+
+static float to_float(int64_t v) {
+	return (float)(v / (double)FX_ONE);
+}
+
+static double to_seconds(int64_t t) {
+	return t == NEVER ? HUGE_VAL : t / (double)FX_ONE;
+}
+
+static void position(int64_t x0, int64_t y0, int64_t vx, int64_t vy, int64_t half_g, int64_t t, int64_t* x, int64_t* y) {
+	*x = x0 + mul(vx, t);
+	*y = y0 + mul(vy, t) + mul(mul(half_g, t), t);
+}
+
+// Mesma lgica de ballistic_exit_time, sobre coeficientes Q16.16
+static int64_t exit_time(int64_t c2, int64_t c1, int64_t c0) {
+	int64_t disc, sq, q, r1, r2;
+
+	if (c2 == 0) {
+		return c1 > 0 ? (c0 >= 0 ? 0 : quot(-c0, c1)) : NEVER;
+	}
+
+	disc = c1 * c1 - 4 * c2 * c0;
+	if (disc < 0) {
+		return c2 > 0 ? 0 : NEVER;
+	}
+
+	sq = (int64_t)fx_isqrt64((uint64_t)disc);
+	q = -(c1 + (c1 >= 0 ? sq : -sq)) / 2;
+	r1 = quot(q, c2);
+	r2 = q != 0 ? quot(c0, q) : r1;
+	if (r1 > r2) {
+		int64_t tmp = r1;
+		r1 = r2;
+		r2 = tmp;
+	}
+
+	if (c2 > 0) {
+		return r2 > 0 ? r2 : 0;
+	}
+	if (r1 >= 0) {
+		return r1;
+	}
+	return r2 > 0 ? 0 : NEVER;
+}
+
+static int64_t window_exit(int64_t x0, int64_t y0, int64_t vx, int64_t vy, int64_t half_g, int64_t width, int64_t height) {
+	int64_t t = NEVER;
+	int64_t e;
+
+	e = exit_time(0, vx, x0 - width);
+	t = e < t ? e : t;
+	e = exit_time(0, -vx, -x0);
+	t = e < t ? e : t;
+	e = exit_time(half_g, vy, y0 - height);
+	t = e < t ? e : t;
+	e = exit_time(-half_g, -vy, -y0);
+	t = e < t ? e : t;
+
+	return t;
+}
+
+static int add_roots(int64_t c2, int64_t c1, int64_t c0, int64_t t_max, int64_t* times, int n) {
+	int64_t r[2];
+	int count = 0;
+
+	if (c2 == 0) {
+		if (c1 != 0) {
+			r[count++] = quot(-c0, c1);
+		}
+	}
+	else {
+		int64_t disc = c1 * c1 - 4 * c2 * c0;
+		if (disc >= 0) {
+			int64_t sq = (int64_t)fx_isqrt64((uint64_t)disc);
+			int64_t q = -(c1 + (c1 >= 0 ? sq : -sq)) / 2;
+			if (q != 0) {
+				r[count++] = quot(q, c2);
+				r[count++] = quot(c0, q);
+			}
+			else {
+				r[count++] = 0;
+			}
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (r[i] >= 0 && r[i] <= t_max) {
+			times[n++] = r[i];
+		}
+	}
+	return n;
+}
+
+void ballistic_position(float x0, float y0, float vx, float vy, float gravity, double t, float* x, float* y) {
+	int64_t px, py;
+
+	position(fx(x0), fx(y0), fx(vx), fx(vy), fx(0.5 * gravity), fx(t), &px, &py);
+	*x = to_float(px);
+	*y = to_float(py);
+}
+
+float ballistic_velocity(float vy, double gravity, double t) {
+	return to_float(fx(vy) + mul(fx(gravity), fx(t)));
+}
+
+double ballistic_exit_time(double c2, double c1, double c0) {
+	return to_seconds(exit_time(fx(c2), fx(c1), fx(c0)));
+}
+
+double ballistic_window_exit(float x0, float y0, float vx, float vy, float gravity, float width, float height) {
+	return to_seconds(window_exit(fx(x0), fx(y0), fx(vx), fx(vy), fx(0.5 * gravity), fx(width), fx(height)));
+}
+
+double ballistic_rect_entry(float x0, float y0, float vx, float vy, float gravity,
+	float rx, float ry, float rw, float rh, double t_max) {
+	const int64_t eps = fx(BALLISTIC_EDGE_EPS);
+	int64_t px0 = fx(x0), py0 = fx(y0), pvx = fx(vx), pvy = fx(vy), half_g = fx(0.5 * gravity);
+	int64_t left = fx(rx), top = fx(ry), right = left + fx(rw), bottom = top + fx(rh);
+	int64_t limit = fx(t_max);
+	int64_t times[9];
+	int64_t best = NEVER;
+	int n = 0;
+
+	times[n++] = 0;
+	n = add_roots(0, pvx, px0 - left, limit, times, n);
+	n = add_roots(0, pvx, px0 - right, limit, times, n);
+	n = add_roots(half_g, pvy, py0 - top, limit, times, n);
+	n = add_roots(half_g, pvy, py0 - bottom, limit, times, n);
+
+	for (int i = 0; i < n; i++) {
+		int64_t x, y;
+
+		position(px0, py0, pvx, pvy, half_g, times[i], &x, &y);
+		if (times[i] < best && x >= left - eps && x <= right + eps && y >= top - eps && y <= bottom + eps) {
+			best = times[i];
+		}
+	}
+
+	return to_seconds(best);
+}
+
+int ballistic_intercept(float tx, float ty, float tvx, float tvy, float sx, float sy, float gravity,
+	float max_speed, double deadline, float width, float height, struct InterceptSolution* out) {
+	// Mesma equao da verso em float, mas escrita sobre a direo e = d / |d|: com s = |d| / T,
+	// |v + e s| = max_speed vira s + 2 (v.e) s + |v| - max_speed = 0. Assim s aparecem
+	// quadrados de velocidades, que cabem em Q32.32, em vez dos de distncias vezes velocidades.
+	int64_t px = fx(tx), py = fx(ty), vx = fx(tvx), vy = fx(tvy), half_g = fx(0.5 * gravity);
+	int64_t dx = px - fx(sx), dy = py - fx(sy), m = fx(max_speed);
+	int64_t d = (int64_t)fx_isqrt64((uint64_t)(dx * dx + dy * dy));
+	int64_t ex, ey, p, disc, s, t, ux, uy;
+
+	if (d == 0) {
+		return 0;
+	}
+
+	ex = quot(dx, d);
+	ey = quot(dy, d);
+	p = mul(vx, ex) + mul(vy, ey);
+	disc = p * p - (vx * vx + vy * vy) + m * m;
+	if (disc < 0) {
+		return 0;
+	}
+
+	// A maior raiz d o menor tempo de voo
+	s = (int64_t)fx_isqrt64((uint64_t)disc) - p;
+	if (s <= 0) {
+		return 0;
+	}
+
+	t = quot(d, s);
+	if (t > fx(deadline)) {
+		return 0;
+	}
+
+	ux = vx + mul(ex, s);
+	uy = vy + mul(ey, s);
+	out->vx = to_float(ux);
+	out->vy = to_float(uy);
+	out->time = to_float(t);
+	position(px, py, vx, vy, half_g, t, &dx, &dy);
+	out->x = to_float(dx);
+	out->y = to_float(dy);
+
+	if (window_exit(fx(sx), fx(sy), ux, uy, half_g, fx(width), fx(height)) < t) {
+		return 0;
+	}
+
+	return 1;
+}
+
+#else
+
+void ballistic_position(float x0, float y0, float vx, float vy, float gravity, double t, float* x, float* y) {
+	*x = (float)(x0 + vx * t);
+	*y = (float)(y0 + vy * t + 0.5 * gravity * t * t);
+}
+
+float ballistic_velocity(float vy, double gravity, double t) {
+	return (float)(vy + gravity * t);
+}
+
+double ballistic_exit_time(double c2, double c1, double c0) {
+	double disc, r1, r2, q;
+
+	// Caso linear
+	if (c2 == 0) {
+		return c1 > 0 ? (c0 >= 0 ? 0 : -c0 / c1) : HUGE_VAL;
+	}
+
+	disc = c1 * c1 - 4 * c2 * c0;
+	if (disc < 0) {
+		// Sem razes: se a parbola  cncava para cima ela seria sempre positiva, o que
+		// contraria a hiptese; se  cncava para baixo ela nunca fica positiva
+		return c2 > 0 ? 0 : HUGE_VAL;
+	}
+
+	// Razes calculadas da forma numericamente estvel
+	q = -0.5 * (c1 + (c1 >= 0 ? sqrt(disc) : -sqrt(disc)));
+	r1 = q / c2;
+	r2 = q != 0 ? c0 / q : r1;
+	if (r1 > r2) {
+		double tmp = r1;
+		r1 = r2;
+		r2 = tmp;
+	}
+
+	if (c2 > 0) {
+		// No positiva apenas entre as razes: sai na maior delas
+		return r2 > 0 ? r2 : 0;
+	}
+
+	// No positiva fora do intervalo entre as razes: sai na menor, se ela ainda no passou
+	if (r1 >= 0) {
+		return r1;
+	}
+	return r2 > 0 ? 0 : HUGE_VAL;
+}
+
+double ballistic_window_exit(float x0, float y0, float vx, float vy, float gravity, float width, float height) {
+	double t = HUGE_VAL;
+	double e;
+
+	// x <= width e x >= 0
+	e = ballistic_exit_time(0, vx, x0 - width);
+	t = e < t ? e : t;
+	e = ballistic_exit_time(0, -vx, -x0);
+	t = e < t ? e : t;
+
+	// y <= height e y >= 0
+	e = ballistic_exit_time(0.5 * gravity, vy, y0 - height);
+	t = e < t ? e : t;
+	e = ballistic_exit_time(-0.5 * gravity, -vy, -y0);
+	t = e < t ? e : t;
+
+	return t;
+}
+
+// Acrescenta a times as razes de c2 t + c1 t + c0 = 0 em [0, t_max]
+static int add_roots(double c2, double c1, double c0, double t_max, double* times, int n) {
+	double r[2];
+	int count = 0;
+
+	if (c2 == 0) {
+		if (c1 != 0) {
+			r[count++] = -c0 / c1;
+		}
+	}
+	else {
+		double disc = c1 * c1 - 4 * c2 * c0;
+		if (disc >= 0) {
+			double q = -0.5 * (c1 + (c1 >= 0 ? sqrt(disc) : -sqrt(disc)));
+			if (q != 0) {
+				r[count++] = q / c2;
+				r[count++] = c0 / q;
+			}
+			else {
+				r[count++] = 0;
+			}
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (r[i] >= 0 && r[i] <= t_max) {
+			times[n++] = r[i];
+		}
+	}
+	return n;
+}
+
+double ballistic_rect_entry(float x0, float y0, float vx, float vy, float gravity,
+	float rx, float ry, float rw, float rh, double t_max) {
+	// O conjunto dos instantes dentro do retngulo  fechado, ento o primeiro deles  t = 0 ou
+	// um instante em que a trajetria cruza uma das quatro bordas. Basta testar esses candidatos.
+	const double eps = BALLISTIC_EDGE_EPS;
+	double times[9];
+	double best = HUGE_VAL;
+	int n = 0;
+
+	times[n++] = 0;
+	n = add_roots(0, vx, x0 - rx, t_max, times, n);
+	n = add_roots(0, vx, x0 - (rx + rw), t_max, times, n);
+	n = add_roots(0.5 * gravity, vy, y0 - ry, t_max, times, n);
+	n = add_roots(0.5 * gravity, vy, y0 - (ry + rh), t_max, times, n);
+
+	for (int i = 0; i < n; i++) {
+		double t = times[i];
+		double x = x0 + vx * t;
+		double y = y0 + vy * t + 0.5 * gravity * t * t;
+
+		if (t < best && x >= rx - eps && x <= rx + rw + eps && y >= ry - eps && y <= ry + rh + eps) {
+			best = t;
+		}
+	}
+
+	return best;
+}
+
+int ballistic_intercept(float tx, float ty, float tvx, float tvy, float sx, float sy, float gravity,
+	float max_speed, double deadline, float width, float height, struct InterceptSolution* out) {
+	// Lanado agora com velocidade u, o interceptor encontra o alvo aps T segundos se
+	// s + u T + g T/2 = t + v T + g T/2, ou seja, u = v + d / T com d = t - s.
+	// Com k = 1 / T, |u| <= max_speed vira a k + b k + c <= 0.
+	double dx = tx - sx;
+	double dy = ty - sy;
+	double a = dx * dx + dy * dy;
+	double b = 2 * (tvx * dx + tvy * dy);
+	double c = (double)tvx * tvx + (double)tvy * tvy - (double)max_speed * max_speed;
+	double disc, k, t;
+
+	if (a == 0) {
+		return 0;
+	}
+
+	disc = b * b - 4 * a * c;
+	if (disc < 0) {
+		return 0;
+	}
+
+	// O maior k possvel d o menor tempo de voo (o interceptor sai com a velocidade mxima)
+	k = (-b + sqrt(disc)) / (2 * a);
+	if (k <= 0) {
+		return 0;
+	}
+
+	t = 1 / k;
+	if (t > deadline) {
+		return 0;
+	}
+
+	out->vx = (float)(tvx + dx * k);
+	out->vy = (float)(tvy + dy * k);
+	out->time = (float)t;
+	ballistic_position(tx, ty, tvx, tvy, gravity, t, &out->x, &out->y);
+
+	// O interceptor precisa continuar dentro da janela grfica at o encontro
+	if (ballistic_window_exit(sx, sy, out->vx, out->vy, gravity, width, height) < t) {
+		return 0;
+	}
+
+	return 1;
+}
+
+#endif
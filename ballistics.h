@@ -0,0 +1,45 @@
+#ifndef BALLISTICS_H
+#define BALLISTICS_H
+
+// Funes analticas sobre trajetrias parablicas p(t) = p0 + v0 t + a t/2.
+// As coordenadas so as da janela grfica: y cresce para baixo e a gravidade  positiva.
+// Com SIM_FIXED_POINT (real.h) as contas so feitas em Q16.16 com inteiros de 64 bits, e as
+// entradas e sadas em float so convertidas nas bordas.
+
+#define BALLISTIC_EDGE_EPS 1e-3 // Folga com que ballistic_rect_entry aceita as bordas do retngulo (unidades)
+
+// Calcula a posio no instante t (relativo ao lanamento)
+void ballistic_position(float x0, float y0, float vx, float vy, float gravity, double t, float* x, float* y);
+
+// Calcula a velocidade y no instante t (relativo ao lanamento)
+float ballistic_velocity(float vy, double gravity, double t);
+
+// Calcula o primeiro instante t >= 0 em que c2 t + c1 t + c0 passa a ser positivo,
+// supondo que no  positivo em t = 0. Retorna HUGE_VAL se isso nunca acontece.
+double ballistic_exit_time(double c2, double c1, double c0);
+
+// Calcula o instante em que a trajetria sai do retngulo [0, width] x [0, height]
+double ballistic_window_exit(float x0, float y0, float vx, float vy, float gravity, float width, float height);
+
+// Calcula o primeiro instante t em [0, t_max] em que a trajetria est dentro do retngulo
+// [rx, rx + rw] x [ry, ry + rh]. Retorna HUGE_VAL se ela no passa pelo retngulo at t_max.
+double ballistic_rect_entry(float x0, float y0, float vx, float vy, float gravity,
+	float rx, float ry, float rw, float rh, double t_max);
+
+// Soluo de interceptao: velocidade de lanamento, tempo de voo e ponto de encontro
+struct InterceptSolution {
+	float vx; // Velocidade x de lanamento do interceptor
+	float vy; // Velocidade y de lanamento do interceptor
+	float time; // Tempo de voo at o encontro
+	float x; // Posio x do encontro
+	float y; // Posio y do encontro
+};
+
+// Calcula o lanamento, a partir de (sx, sy) e com velocidade de no mximo max_speed, que encontra
+// o alvo (tx, ty, tvx, tvy) o mais cedo possvel e antes de deadline segundos. Os dois esto sob
+// a mesma gravidade, ento ela se cancela no movimento relativo e a soluo  exata.
+// Retorna 0 se no existe interceptao possvel.
+int ballistic_intercept(float tx, float ty, float tvx, float tvy, float sx, float sy, float gravity,
+	float max_speed, double deadline, float width, float height, struct InterceptSolution* out);
+
+#endif
@@ -0,0 +1,340 @@
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "batch.h"
+#include "host.h"
+#include "ring.h"
+
+// Empacota um intervalo [b, e) de ndices de cenrios numa palavra de 64 bits
+#define RANGE_PACK(b, e) (((uint64_t)(uint32_t)(b) << 32) | (uint32_t)(e))
+#define RANGE_BEGIN(r) ((int)((r) >> 32))
+#define RANGE_END(r) ((int)((r) & 0xFFFFFFFFu))
+
+// Valor crtico da normal para o intervalo de confiana de 95%
+#define CI_Z 1.96
+
+struct Batch;
+
+// Thread de trabalho. Cada uma tem o seu intervalo de cenrios pendentes, do qual retira
+// pelo incio; quando fica sem trabalho, rouba metade do final do intervalo de outra.
+struct Worker {
+	_Alignas(64) atomic_uint_least64_t range; // Cenrios pendentes [incio, fim)
+	int id; // ndice da thread
+	struct Batch* batch; // Lote ao qual pertence
+	struct BatchContext* context; // Simulao e buffers reaproveitados entre os cenrios desta thread
+	struct HostThread thread; // Thread do sistema
+};
+
+// Estado compartilhado de um lote
+struct Batch {
+	const struct BatchConfig* config;
+	struct Worker* workers;
+	int num_workers;
+	struct ScenarioResult* results; // Resultado de cada cenrio, indexado pelo cenrio
+};
+
+// Funo que deriva a semente do cenrio i a partir da semente base
+static uint64_t scenario_seed(uint64_t seed, int i) {
+	return rng_mix(seed, (uint64_t)i);
+}
+
+int batch_context_create(struct BatchContext* ctx, const struct SimConfig* config, int events) {
+	size_t bytes = sim_arena_bytes(config)
+		+ ARENA_BYTES(config->missiles_per_wave * sizeof(struct LaunchDescriptor), sizeof(double))
+		+ ARENA_BYTES(SPSC_RING_BYTES(config->ring_capacity, sizeof(struct LaunchDescriptor)), sizeof(double))
+		+ ARENA_BYTES(config->interceptors_per_defense * sizeof(struct LaunchDescriptor), sizeof(double))
+		+ assign_arena_bytes(config)
+		+ (events ? events_arena_bytes(config) : 0);
+
+	ctx->events = events;
+	ctx->memory = host_aligned_alloc(ENTITY_ALIGN, bytes);
+	if (ctx->memory == NULL) {
+		return -1;
+	}
+	arena_init(&ctx->arena, ctx->memory, bytes);
+
+	if (sim_create(&ctx->sim, config, &ctx->arena) != 0 || (events && events_create(&ctx->engine, config, &ctx->arena) != 0)) {
+		batch_context_destroy(ctx);
+		return -1;
+	}
+	ctx->wave = arena_alloc(&ctx->arena, config->missiles_per_wave * sizeof(struct LaunchDescriptor), sizeof(double));
+	ctx->threats = arena_alloc(&ctx->arena, SPSC_RING_BYTES(config->ring_capacity, sizeof(struct LaunchDescriptor)), sizeof(double));
+	ctx->defense = arena_alloc(&ctx->arena, config->interceptors_per_defense * sizeof(struct LaunchDescriptor), sizeof(double));
+	if (ctx->wave == NULL || ctx->threats == NULL || ctx->defense == NULL || assign_create(&ctx->assign, config, &ctx->arena) != 0) {
+		batch_context_destroy(ctx);
+		return -1;
+	}
+	return 0;
+}
+
+void batch_context_destroy(struct BatchContext* ctx) {
+	host_aligned_free(ctx->memory);
+	ctx->memory = NULL;
+}
+
+// Funo que executa um cenrio reproduzindo o comportamento das tarefas de ataque, defesa e monitor
+void batch_scenario(struct BatchContext* ctx, uint64_t seed, float duration, struct ScenarioResult* out) {
+	struct Simulation* sim = &ctx->sim;
+	struct EventEngine* engine = ctx->events ? &ctx->engine : NULL;
+	struct LaunchDescriptor* wave = ctx->wave;
+	struct LaunchDescriptor threat;
+	// Ameaas ainda no vistas pela defesa (o mesmo anel que liga as tarefas de ataque e defesa)
+	struct SpscRing threat_ring;
+	unsigned int capacity = sim->config.ring_capacity;
+	int steps = (int)(duration / SIM_DT);
+	int queued = 0;
+	double next_attack = 0;
+	double next_defense = 0;
+
+	spsc_init(&threat_ring, capacity, sizeof(struct LaunchDescriptor), ctx->threats);
+	sim->config.seed = seed;
+	init(sim);
+	assign_reset(&ctx->assign);
+	if (engine != NULL) {
+		events_init(engine, sim, SIM_DT);
+	}
+
+	for (int step = 0; step < steps; step++) {
+		double t = sim->time;
+		int arrived = 0;
+
+		// Ataque: lana uma onda e agenda a prxima para daqui a um intervalo aleatrio
+		if (t >= next_attack && queued + sim->config.missiles_per_wave <= (int)capacity) {
+			int n = attack_wave(sim, t, wave);
+
+			for (int i = 0; i < n; i++) {
+				if (engine != NULL) {
+					events_launch_missile(engine, &wave[i]);
+				}
+				else {
+					launch_missile(sim, &wave[i]);
+				}
+				spsc_push(&threat_ring, &wave[i]);
+			}
+			queued += n;
+			arrived = n > 0;
+			next_attack = t + rng_float(&sim->attack_rng, 1, ATTACK_INTERVAL) / 1000.0f;
+		}
+
+		// Defesa: acorda quando chega uma onda (como a notificao da tarefa de ataque) ou no
+		// instante pedido por assign_next_wake, acumula as ameaas pendentes e atribui at
+		// interceptors_per_defense interceptores s mais urgentes, no mximo uma salva a cada DEFENSE_INTERVAL
+		if (arrived || t >= next_defense) {
+			int launched;
+
+			while (ctx->assign.pending < ctx->assign.capacity && spsc_pop(&threat_ring, &threat)) {
+				queued--;
+				assign_add_threat(&ctx->assign, &threat);
+			}
+			launched = defense_assign(sim, &ctx->assign, t, ctx->defense);
+			for (int i = 0; i < launched; i++) {
+				if (engine != NULL) {
+					events_launch_interceptor(engine, &ctx->defense[i]);
+				}
+				else {
+					launch_interceptor(sim, &ctx->defense[i]);
+				}
+			}
+			next_defense = assign_next_wake(&ctx->assign, t);
+		}
+
+		// Monitor: avana a simulao um passo fixo. O motor de eventos s trabalha nos passos
+		// em que algo acontece; o relgio  sempre calculado a partir do nmero do passo.
+		if (engine != NULL) {
+			events_advance(engine, 1);
+		}
+		else {
+			update(sim, SIM_DT);
+		}
+	}
+
+	batch_collect(sim, out);
+}
+
+void batch_collect(const struct Simulation* sim, struct ScenarioResult* out) {
+	out->num_missiles = (int)stats_read(&sim->counters, STATS_MISSILES);
+	out->num_interceptors = (int)stats_read(&sim->counters, STATS_INTERCEPTORS);
+	out->num_hits = (int)stats_read(&sim->counters, STATS_HITS);
+	out->num_intercepts = (int)stats_read(&sim->counters, STATS_INTERCEPTS);
+}
+
+// Funo que retira o prximo cenrio do prprio intervalo, ou -1 se estiver vazio
+static int take_local(struct Worker* w) {
+	uint64_t r = atomic_load(&w->range);
+
+	while (RANGE_BEGIN(r) < RANGE_END(r)) {
+		if (atomic_compare_exchange_weak(&w->range, &r, RANGE_PACK(RANGE_BEGIN(r) + 1, RANGE_END(r)))) {
+			return RANGE_BEGIN(r);
+		}
+	}
+
+	return -1;
+}
+
+// Funo que rouba metade do trabalho de outra thread, ou retorna -1 se todas esto vazias
+static int steal(struct Worker* self) {
+	struct Batch* b = self->batch;
+
+	for (int k = 1; k < b->num_workers; k++) {
+		struct Worker* victim = &b->workers[(self->id + k) % b->num_workers];
+		uint64_t r = atomic_load(&victim->range);
+
+		while (RANGE_BEGIN(r) < RANGE_END(r)) {
+			int begin = RANGE_BEGIN(r);
+			int end = RANGE_END(r);
+			int split = end - (end - begin + 1) / 2;
+
+			// Retira [split, end) da vtima; o primeiro  executado agora e o resto vira trabalho prprio
+			if (atomic_compare_exchange_weak(&victim->range, &r, RANGE_PACK(begin, split))) {
+				atomic_store(&self->range, RANGE_PACK(split + 1, end));
+				return split;
+			}
+		}
+	}
+
+	return -1;
+}
+
+// Funo executada por cada thread de trabalho
+static void worker_main(void* arg) {
+	struct Worker* w = (struct Worker*)arg;
+	struct Batch* b = w->batch;
+	int i;
+
+	while (1) {
+		i = take_local(w);
+		if (i < 0) {
+			i = steal(w);
+		}
+		if (i < 0) {
+			break;
+		}
+
+		batch_scenario(w->context, scenario_seed(b->config->seed, i), b->config->duration, &b->results[i]);
+	}
+}
+
+// Funo que calcula a mdia e o intervalo de confiana de uma amostra
+static struct BatchStat sample_stat(const double* v, int n) {
+	struct BatchStat s = { 0, 0 };
+	double var = 0;
+
+	for (int i = 0; i < n; i++) {
+		s.mean += v[i];
+	}
+	s.mean /= n;
+
+	if (n > 1) {
+		for (int i = 0; i < n; i++) {
+			var += (v[i] - s.mean) * (v[i] - s.mean);
+		}
+		var /= n - 1;
+		s.ci = CI_Z * sqrt(var / n);
+	}
+
+	return s;
+}
+
+int batch_run(const struct BatchConfig* config, struct BatchResult* result) {
+	struct Batch b;
+	int n = config->scenarios;
+	int per, extra, begin;
+	double* v;
+
+	if (n <= 0) {
+		return -1;
+	}
+
+	b.config = config;
+	b.num_workers = config->threads > 0 ? config->threads : host_cpu_count();
+	if (b.num_workers > n) {
+		b.num_workers = n;
+	}
+
+	b.workers = host_aligned_alloc(64, b.num_workers * sizeof(struct Worker));
+	b.results = calloc(n, sizeof(struct ScenarioResult));
+	v = malloc(n * sizeof(double));
+	if (b.workers == NULL || b.results == NULL || v == NULL) {
+		host_aligned_free(b.workers);
+		free(b.results);
+		free(v);
+		return -1;
+	}
+
+	// Divide os cenrios em intervalos contguos, um por thread, e reserva de uma vez a memria
+	// de cada thread
+	per = n / b.num_workers;
+	extra = n % b.num_workers;
+	begin = 0;
+	for (int k = 0; k < b.num_workers; k++) {
+		int size = per + (k < extra ? 1 : 0);
+		struct Worker* w = &b.workers[k];
+
+		atomic_init(&w->range, RANGE_PACK(begin, begin + size));
+		w->id = k;
+		w->batch = &b;
+		w->context = host_aligned_alloc(64, sizeof(struct BatchContext));
+		if (w->context == NULL || batch_context_create(w->context, &config->sim, config->events) != 0) {
+			host_aligned_free(w->context);
+			while (k-- > 0) {
+				batch_context_destroy(b.workers[k].context);
+				host_aligned_free(b.workers[k].context);
+			}
+			host_aligned_free(b.workers);
+			free(b.results);
+			free(v);
+			return -1;
+		}
+		begin += size;
+	}
+
+	for (int k = 0; k < b.num_workers; k++) {
+		host_thread_start(&b.workers[k].thread, worker_main, &b.workers[k]);
+	}
+
+	for (int k = 0; k < b.num_workers; k++) {
+		host_thread_join(&b.workers[k].thread);
+		batch_context_destroy(b.workers[k].context);
+		host_aligned_free(b.workers[k].context);
+	}
+
+	// Agrega os resultados na ordem dos cenrios, independente de qual thread executou cada um
+	batch_summarize(b.results, n, v, result);
+	result->threads = b.num_workers;
+
+	host_aligned_free(b.workers);
+	free(b.results);
+	free(v);
+
+	return 0;
+}
+
+void batch_summarize(const struct ScenarioResult* results, int n, double* v, struct BatchResult* result) {
+	result->scenarios = n;
+	result->threads = 1;
+
+	for (int i = 0; i < n; i++) v[i] = results[i].num_missiles;
+	result->missiles = sample_stat(v, n);
+	for (int i = 0; i < n; i++) v[i] = results[i].num_interceptors;
+	result->interceptors = sample_stat(v, n);
+	for (int i = 0; i < n; i++) v[i] = results[i].num_hits;
+	result->hits = sample_stat(v, n);
+	for (int i = 0; i < n; i++) v[i] = results[i].num_intercepts;
+	result->intercepts = sample_stat(v, n);
+	for (int i = 0; i < n; i++) {
+		int ended = results[i].num_hits + results[i].num_intercepts;
+		v[i] = ended > 0 ? (double)results[i].num_intercepts / ended : 0;
+	}
+	result->intercept_rate = sample_stat(v, n);
+}
+
+void batch_print(const struct BatchResult* result, FILE* out) {
+	fprintf(out, "Cenrios: %d (%d threads)\n", result->scenarios, result->threads);
+	fprintf(out, "Msseis disparados:     %10.2f +/- %.2f\n", result->missiles.mean, result->missiles.ci);
+	fprintf(out, "Interceptores:          %10.2f +/- %.2f\n", result->interceptors.mean, result->interceptors.ci);
+	fprintf(out, "Acertos (num_hits):     %10.2f +/- %.2f\n", result->hits.mean, result->hits.ci);
+	fprintf(out, "Interceptaes:         %10.2f +/- %.2f\n", result->intercepts.mean, result->intercepts.ci);
+	fprintf(out, "Taxa de interceptao:  %10.4f +/- %.4f\n", result->intercept_rate.mean, result->intercept_rate.ci);
+}
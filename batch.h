@@ -0,0 +1,81 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "assign.h"
+#include "events.h"
+#include "simulation.h"
+
+// Parmetros do modo em lote
+struct BatchConfig {
+	int scenarios; // Nmero de cenrios independentes
+	int threads; // Nmero de threads de trabalho (0 usa todos os ncleos)
+	float duration; // Tempo simulado de cada cenrio em segundos
+	uint64_t seed; // Semente base; o cenrio i usa uma semente derivada de seed e i
+	int events; // Usa o motor de eventos discretos em vez de update() a cada passo
+	struct SimConfig sim; // Capacidades e janela de cada cenrio
+};
+
+// Resultado de um cenrio
+struct ScenarioResult {
+	int num_missiles; // Msseis disparados
+	int num_interceptors; // Interceptores disparados
+	int num_hits; // Msseis que atingiram as reas
+	int num_intercepts; // Msseis interceptados
+};
+
+// Mdia de uma grandeza sobre os cenrios e meia-largura do intervalo de confiana de 95%
+struct BatchStat {
+	double mean;
+	double ci;
+};
+
+// Estatsticas agregadas de um lote
+struct BatchResult {
+	int scenarios; // Cenrios executados
+	int threads; // Threads usadas
+	struct BatchStat missiles;
+	struct BatchStat interceptors;
+	struct BatchStat hits;
+	struct BatchStat intercepts;
+	struct BatchStat intercept_rate; // Frao dos msseis que chegaram ao fim e foram interceptados
+};
+
+// Memria de trabalho de uma thread do lote: a simulao, o motor de eventos e os buffers que as
+// tarefas usariam, todos retirados de uma nica arena alocada uma vez
+struct BatchContext {
+	struct Simulation sim; // Simulao reaproveitada entre os cenrios
+	struct EventEngine engine; // Motor de eventos (usado s se events for 1)
+	int events; // Avana os cenrios pelo motor de eventos em vez de update()
+	struct LaunchDescriptor* wave; // Onda de ataque (config.missiles_per_wave descritores)
+	struct LaunchDescriptor* threats; // Memria do anel de ameaas (config.ring_capacity descritores)
+	struct Assignment assign; // Ameaas acumuladas pela defesa e atribuio dos interceptores
+	struct LaunchDescriptor* defense; // Interceptores de uma ativao da defesa (config.interceptors_per_defense descritores)
+	struct Arena arena; // Arena de onde sai toda a memria acima
+	void* memory; // Regio da arena
+};
+
+// Aloca a memria de um contexto para a configurao. Retorna 0 em caso de sucesso.
+int batch_context_create(struct BatchContext* ctx, const struct SimConfig* config, int events);
+
+// Libera a memria de um contexto
+void batch_context_destroy(struct BatchContext* ctx);
+
+// Executa um cenrio completo, sem o escalonador, com a mesma lgica das tarefas
+void batch_scenario(struct BatchContext* ctx, uint64_t seed, float duration, struct ScenarioResult* out);
+
+// Copia os contadores de uma simulao (de um cenrio ou reconstruda por replay.h) para um resultado
+void batch_collect(const struct Simulation* sim, struct ScenarioResult* out);
+
+// Agrega n resultados, usando v (n posies) como memria de trabalho
+void batch_summarize(const struct ScenarioResult* results, int n, double* v, struct BatchResult* result);
+
+// Executa todos os cenrios distribudos entre as threads. Retorna 0 em caso de sucesso.
+int batch_run(const struct BatchConfig* config, struct BatchResult* result);
+
+// Imprime as estatsticas agregadas
+void batch_print(const struct BatchResult* result, FILE* out);
+
+#endif
@@ -0,0 +1,407 @@
+// Benchmark dos kernels da simulao, compilado sem o FreeRTOS (os mdulos da simulao no
+// dependem do escalonador). Varre o nmero de entidades desde o tamanho atual do sistema
+// (NUM_MISSILES msseis e NUM_INTERCEPTORS interceptores) at 10^5 e imprime uma linha CSV por
+// kernel e tamanho, para ser comparada entre verses.
+//
+// Compilao, a partir da raiz do repositrio:
+//   cc -std=c11 -O2 -I. bench/bench.c arena.c entities.c grid.c simulation.c ballistics.c fastmath.c fixed.c areas.c events.c host.c stats.c tick.c rng.c -lm -pthread -o bench_sim
+//
+// Com -DSIM_FIXED_POINT=1 mede os kernels em ponto fixo.
+//
+// Uso: bench_sim [entidades-passo por medio]
+//
+// Colunas: kernel, missiles, interceptors, ticks, ns_per_entity_tick, entities_per_s, cache_misses_per_entity_tick.
+// As falhas de cache vm do perf_event_open e ficam em -1 quando o contador no est disponvel
+// (fora do Linux ou sem permisso). Cada tamanho cria a sua simulao com uma struct SimConfig
+// de capacidades iguais ao tamanho. O motor de eventos s  medido at BENCH_EVENTS_MAX msseis,
+// porque cada lanamento nele testa todos os pares mssil-interceptor. A linha tick_update  o
+// passo paralelo de tick.h com uma thread por ncleo.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "entities.h"
+#include "events.h"
+#include "fastmath.h"
+#include "grid.h"
+#include "host.h"
+#include "simulation.h"
+#include "tick.h"
+
+#define BENCH_DEFAULT_BUDGET 20000000.0 // Entidades-passo por medio
+#define BENCH_MIN_TICKS 100 // Nmero mnimo de passos por medio
+#define BENCH_WORLD_DENSITY 4 // Clulas da grade por entidade nos kernels sintticos
+#define BENCH_VELOCITY_RESET 256 // Passos entre as renovaes das velocidades nos kernels sintticos
+#define BENCH_EVENTS_MAX 1000 // Maior nmero de msseis medido no motor de eventos
+
+// Nmero de msseis de cada tamanho da varredura; os interceptores so a metade, como 10/5 hoje
+static const int sizes[] = { NUM_MISSILES, 100, 1000, 10000, 100000 };
+
+// Medidor de tempo e de falhas de cache, acumulado entre start e stop
+struct Meter {
+	int fd; // Descritor do contador de falhas de cache, ou -1
+	uint64_t ns; // Tempo acumulado
+	uint64_t misses; // Falhas de cache acumuladas
+	uint64_t started; // Instante do ltimo start
+};
+
+// Evita que o compilador descarte os resultados dos kernels
+static volatile float sink;
+
+// Gerador dos dados sintticos e dos lanamentos
+static struct Rng rng;
+
+static void meter_open(struct Meter* m) {
+	m->fd = host_cache_counter_open();
+	m->ns = 0;
+	m->misses = 0;
+}
+
+static void meter_close(struct Meter* m) {
+	host_counter_close(m->fd);
+}
+
+static void meter_start(struct Meter* m) {
+	host_counter_start(m->fd);
+	m->started = host_time_ns();
+}
+
+static void meter_stop(struct Meter* m) {
+	m->ns += host_time_ns() - m->started;
+	m->misses += host_counter_stop(m->fd);
+}
+
+// Funo que imprime a linha de um kernel
+static void report(const char* kernel, int missiles, int interceptors, long ticks, double entities, const struct Meter* m) {
+	double work = entities * ticks;
+	double misses = m->fd >= 0 ? m->misses / work : -1;
+
+	printf("%s,%d,%d,%ld,%.3f,%.0f,%.4f\n", kernel, missiles, interceptors, ticks,
+		m->ns / work, work / (m->ns * 1e-9), misses);
+	fflush(stdout);
+}
+
+// Funo que escolhe o nmero de passos de uma medio com o oramento de entidades-passo
+static long ticks_for(double budget, double entities) {
+	long ticks = (long)(budget / entities);
+	return ticks < BENCH_MIN_TICKS ? BENCH_MIN_TICKS : ticks;
+}
+
+// Funo que preenche um armazenamento com n entidades ativas espalhadas num mundo de lado world
+static void scatter(struct EntityStore* s, int n, float world) {
+	for (int k = 0; k < n; k++) {
+		int i = ENTITY_INDEX(entities_alloc(s));
+
+		s->x[i] = real_from_float(rng_float(&rng, 0, world));
+		s->y[i] = real_from_float(rng_float(&rng, 0, world));
+		s->vx[i] = real_from_float(rng_float(&rng, -200, 200));
+		s->vy[i] = real_from_float(rng_float(&rng, -200, 200));
+		entities_set_active(s, i, 1);
+	}
+}
+
+// Integrao e sincronizao da grade para n entidades sintticas. O mundo cresce com n para
+// manter a densidade, e as posies do a volta nas bordas fora da medio para no se acumularem.
+static void bench_kernels(int n, double budget) {
+	int cols = (int)ceil(sqrt((double)BENCH_WORLD_DENSITY * n));
+	float world = cols * (float)GRID_CELL_SIZE;
+	real_t side = real_from_float(world);
+	long ticks = ticks_for(budget, n);
+	void* store_buffer = host_aligned_alloc(ENTITY_ALIGN, ENTITY_STORE_BYTES(n));
+	void* grid_buffer = malloc(GRID_BYTES(cols, cols, n));
+	struct EntityStore s;
+	struct Grid g;
+	struct Meter integrate, sync;
+
+	entities_init(&s, n, store_buffer);
+	grid_init(&g, cols, cols, GRID_CELL_SIZE, n, grid_buffer);
+	scatter(&s, n, world);
+	grid_sync(&g, &s);
+	meter_open(&integrate);
+	meter_open(&sync);
+
+	for (long t = 0; t < ticks; t++) {
+		// A janela  to grande que ningum  liberado: mede s o custo do kernel
+		meter_start(&integrate);
+		entities_integrate(&s, GRAVITY, SIM_DT, 1e30f, 1e30f);
+		meter_stop(&integrate);
+
+		for (int i = 0; i < s.capacity; i++) {
+			s.x[i] = s.x[i] < 0 ? s.x[i] + side : (s.x[i] >= side ? s.x[i] - side : s.x[i]);
+			s.y[i] = s.y[i] < 0 ? s.y[i] + side : (s.y[i] >= side ? s.y[i] - side : s.y[i]);
+			if (t % BENCH_VELOCITY_RESET == 0) {
+				s.vy[i] = real_from_float(rng_float(&rng, -200, 200));
+			}
+		}
+
+		meter_start(&sync);
+		grid_sync(&g, &s);
+		meter_stop(&sync);
+	}
+
+	report("entities_integrate", n, 0, ticks, n, &integrate);
+	report("grid_sync", n, 0, ticks, n, &sync);
+	meter_close(&integrate);
+	meter_close(&sync);
+	host_aligned_free(store_buffer);
+	free(grid_buffer);
+}
+
+// Testes de ponto: is_intercepted e is_intercepted_swept sobre n pares, is_in_area sobre n pontos e todas as reas e find_area sobre os mesmos pontos
+static void bench_predicates(struct Simulation* sim, int n, double budget) {
+	long ticks = ticks_for(budget, n);
+	float* p = malloc(4 * (size_t)n * sizeof(float));
+	real_t* q = malloc(4 * (size_t)n * sizeof(real_t));
+	struct Meter intercepted, swept, in_area, find;
+	real_t step = real_from_float(SIM_DT);
+	int hits = 0;
+
+	for (int k = 0; k < 4 * n; k++) {
+		p[k] = rng_float(&rng, 0, WINDOW_WIDTH);
+		q[k] = real_from_float(p[k]);
+	}
+	meter_open(&intercepted);
+	meter_open(&swept);
+	meter_open(&in_area);
+	meter_open(&find);
+
+	meter_start(&intercepted);
+	for (long t = 0; t < ticks; t++) {
+		for (int k = 0; k < n; k++) {
+			hits += is_intercepted(q[4 * k], q[4 * k + 1], q[4 * k + 2], q[4 * k + 3]);
+		}
+	}
+	meter_stop(&intercepted);
+
+	// O mesmo teste ao longo de um passo, com a diferena entre os dois pontos como velocidade relativa
+	meter_start(&swept);
+	for (long t = 0; t < ticks; t++) {
+		for (int k = 0; k < n; k++) {
+			hits += is_intercepted_swept(q[4 * k], q[4 * k + 1], q[4 * k + 2], q[4 * k + 3],
+				q[4 * k + 2] - q[4 * k], q[4 * k + 3] - q[4 * k + 1], step);
+		}
+	}
+	meter_stop(&swept);
+
+	meter_start(&in_area);
+	for (long t = 0; t < ticks; t++) {
+		for (int k = 0; k < n; k++) {
+			for (int j = 0; j < sim->config.num_areas; j++) {
+				hits += is_in_area(p[4 * k], p[4 * k + 1], &sim->areas[j]);
+			}
+		}
+	}
+	meter_stop(&in_area);
+
+	// A mesma consulta pelo ndice espacial das reas
+	meter_start(&find);
+	for (long t = 0; t < ticks; t++) {
+		for (int k = 0; k < n; k++) {
+			hits += find_area(sim, p[4 * k], p[4 * k + 1]) >= 0;
+		}
+	}
+	meter_stop(&find);
+
+	sink = (float)hits;
+	report("is_intercepted", n, n, ticks, n, &intercepted);
+	report("is_intercepted_swept", n, n, ticks, n, &swept);
+	report("is_in_area", n, 0, ticks, n, &in_area);
+	report("find_area", n, 0, ticks, n, &find);
+	meter_close(&intercepted);
+	meter_close(&swept);
+	meter_close(&in_area);
+	meter_close(&find);
+	free(p);
+	free(q);
+}
+
+// Funo que descreve um mssil como a tarefa de ataque, no instante atual da simulao
+static void random_missile(struct Simulation* sim, struct LaunchDescriptor* d) {
+	float angle = rng_float(&rng, 10, 80);
+	float speed = rng_float(&rng, 100, 200);
+	float vx, vy;
+
+	fm_polar_deg_batch(&angle, &speed, &vx, &vy, 1, 1.0f, -1.0f);
+	describe_missile(sim, d, sim->time, 0, sim->config.height, angle, speed, vx, vy);
+}
+
+// Funo que descreve um interceptor lanado numa direo aleatria para cima e para a esquerda
+static void random_interceptor(struct Simulation* sim, struct LaunchDescriptor* d) {
+	float angle = rng_float(&rng, 10, 80);
+	float speed = rng_float(&rng, 100, INTERCEPTOR_MAX_SPEED);
+	float vx, vy;
+
+	fm_polar_deg_batch(&angle, &speed, &vx, &vy, 1, -1.0f, -1.0f);
+	describe_interceptor(sim, d, sim->time, sim->config.width, sim->config.height, angle, speed, vx, vy);
+}
+
+// Mira e lanamento: calculate_intercept e describe_missile + launch_missile para n entidades
+static void bench_launch(struct Simulation* sim, int n, double budget) {
+	long ticks = ticks_for(budget, n);
+	struct LaunchDescriptor* d = malloc((size_t)n * sizeof(struct LaunchDescriptor));
+	struct LaunchDescriptor m;
+	struct Meter aim, launch;
+	float angle, speed, vx, vy, flight;
+	int solved = 0;
+
+	init(sim);
+	for (int k = 0; k < n; k++) {
+		random_missile(sim, &d[k]);
+	}
+	meter_open(&aim);
+	meter_open(&launch);
+
+	meter_start(&aim);
+	for (long t = 0; t < ticks; t++) {
+		for (int k = 0; k < n; k++) {
+			solved += calculate_intercept(sim, &d[k], 0.5, 0, &angle, &speed, &vx, &vy, &flight);
+		}
+	}
+	meter_stop(&aim);
+	sink = (float)solved;
+	report("calculate_intercept", n, 0, ticks, n, &aim);
+
+	// A simulao comporta n msseis, ento cada passo lana n e depois os libera fora da medio
+	for (long t = 0; t < ticks; t++) {
+		meter_start(&launch);
+		for (int k = 0; k < n; k++) {
+			random_missile(sim, &m);
+			launch_missile(sim, &m);
+		}
+		meter_stop(&launch);
+
+		for (int i = entities_next_active(&sim->missiles, 0); i >= 0; i = entities_next_active(&sim->missiles, i + 1)) {
+			entities_release(&sim->missiles, i);
+		}
+	}
+	report("launch_missile", n, 0, ticks, n, &launch);
+
+	meter_close(&aim);
+	meter_close(&launch);
+	free(d);
+}
+
+// Funo que completa a simulao at ter missiles msseis e interceptors interceptores ativos
+static void refill(struct Simulation* sim, struct EventEngine* e, int missiles, int interceptors, int* live_m, int* live_i) {
+	struct LaunchDescriptor d;
+
+	for (; *live_m < missiles; (*live_m)++) {
+		random_missile(sim, &d);
+		if (e != NULL) {
+			events_launch_missile(e, &d);
+		}
+		else {
+			launch_missile(sim, &d);
+		}
+	}
+	for (; *live_i < interceptors; (*live_i)++) {
+		random_interceptor(sim, &d);
+		if (e != NULL) {
+			events_launch_interceptor(e, &d);
+		}
+		else {
+			launch_interceptor(sim, &d);
+		}
+	}
+}
+
+// Funo que conta as entidades ativas de um armazenamento
+static int count_active(const struct EntityStore* s) {
+	int n = 0;
+
+	for (int i = entities_next_active(s, 0); i >= 0; i = entities_next_active(s, i + 1)) {
+		n++;
+	}
+	return n;
+}
+
+// Passo completo da simulao (update), o mesmo trabalho pelo motor de eventos ou pelo passo
+// paralelo (tick_update), mantendo constante o nmero de entidades em voo
+static void bench_update(struct Simulation* sim, struct EventEngine* e, struct TickPool* pool, int missiles, int interceptors, double budget) {
+	const char* kernel = e != NULL ? "events_advance" : (pool != NULL ? "tick_update" : "update");
+	long ticks = ticks_for(budget, missiles + interceptors);
+	struct Meter m;
+	int live_m = 0, live_i = 0;
+
+	init(sim);
+	if (e != NULL) {
+		events_init(e, sim, SIM_DT);
+	}
+	meter_open(&m);
+
+	for (long t = 0; t < ticks; t++) {
+		refill(sim, e, missiles, interceptors, &live_m, &live_i);
+
+		meter_start(&m);
+		if (e != NULL) {
+			events_advance(e, 1);
+		}
+		else if (pool != NULL) {
+			tick_update(pool, SIM_DT);
+		}
+		else {
+			update(sim, SIM_DT);
+		}
+		meter_stop(&m);
+
+		live_m = count_active(&sim->missiles);
+		live_i = count_active(&sim->interceptors);
+	}
+
+	report(kernel, missiles, interceptors, ticks, missiles + interceptors, &m);
+	meter_close(&m);
+}
+
+int main(int argc, char** argv) {
+	double budget = argc > 1 ? atof(argv[1]) : BENCH_DEFAULT_BUDGET;
+	int threads = host_cpu_count() < TICK_MAX_THREADS ? host_cpu_count() : TICK_MAX_THREADS;
+
+	if (budget <= 0) {
+		fprintf(stderr, "uso: %s [entidades-passo por medio]\n", argv[0]);
+		return 1;
+	}
+
+	rng_seed(&rng, SIM_DEFAULT_SEED, 0);
+	printf("kernel,missiles,interceptors,ticks,ns_per_entity_tick,entities_per_s,cache_misses_per_entity_tick\n");
+
+	for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+		int n = sizes[k];
+		struct SimConfig config;
+		struct Simulation sim;
+		struct EventEngine e;
+		struct TickPool pool;
+		struct Arena arena;
+		size_t bytes;
+		void* memory;
+
+		// Simulao com capacidade para n msseis e n/2 interceptores em voo
+		sim_default_config(&config);
+		config.missiles_per_wave = n;
+		config.max_missiles = n;
+		config.max_interceptors = n / 2 > 0 ? n / 2 : 1;
+		bytes = sim_arena_bytes(&config) + events_arena_bytes(&config) + tick_arena_bytes(&config, threads);
+		memory = host_aligned_alloc(ENTITY_ALIGN, bytes);
+		arena_init(&arena, memory, bytes);
+		if (sim_create(&sim, &config, &arena) != 0 || events_create(&e, &config, &arena) != 0
+			|| tick_create(&pool, &sim, threads, &arena) != 0) {
+			fprintf(stderr, "falha ao criar a simulao com %d msseis\n", n);
+			return 1;
+		}
+		init(&sim);
+
+		bench_kernels(n, budget);
+		bench_predicates(&sim, n, budget);
+		bench_launch(&sim, n, budget);
+		bench_update(&sim, NULL, NULL, n, n / 2, budget);
+		bench_update(&sim, NULL, &pool, n, n / 2, budget);
+		if (n <= BENCH_EVENTS_MAX) {
+			bench_update(&sim, &e, NULL, n, n / 2, budget);
+		}
+
+		tick_destroy(&pool);
+		host_aligned_free(memory);
+	}
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+#include <string.h>
+
+#include "entities.h"
+
+#if ENTITIES_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// Funo que inicializa o armazenamento de entidades sobre um buffer j alocado
+void entities_init(struct EntityStore* s, int capacity, void* buffer) {
+	// Cada vetor de 4 bytes ocupa um mltiplo de ENTITY_ALIGN bytes, ento todos continuam alinhados
+	int n = ENTITY_ROUND_CAPACITY(capacity);
+	real_t* r = (real_t*)((double*)buffer + n);
+	float* f = (float*)(r + 4 * n);
+
+	s->capacity = n;
+	s->impact_time = (double*)buffer;
+	s->x = r;
+	s->y = r + n;
+	s->vx = r + 2 * n;
+	s->vy = r + 3 * n;
+	s->angle = f;
+	s->speed = f + n;
+	s->free_list = (int32_t*)(f + 2 * n);
+	s->impact_area = (int16_t*)(s->free_list + n);
+	s->targeted = (uint8_t*)(s->impact_area + n);
+	s->generation = s->targeted + n;
+	s->active = (uint32_t*)(s->generation + n);
+
+	// Comea com todas as entidades inativas e zeradas
+	memset(buffer, 0, ENTITY_STORE_BYTES(capacity));
+
+	// Empilha os ndices em ordem decrescente, para que as alocaes comecem pelo ndice 0
+	// e as entidades vivas fiquem concentradas nas primeiras palavras da mscara
+	s->free_count = n;
+	for (int i = 0; i < n; i++) {
+		s->free_list[i] = n - 1 - i;
+	}
+}
+
+EntityHandle entities_alloc(struct EntityStore* s) {
+	if (s->free_count == 0) {
+		return ENTITY_NONE;
+	}
+
+	return entities_handle(s, s->free_list[--s->free_count]);
+}
+
+void entities_release(struct EntityStore* s, int i) {
+	entities_set_active(s, i, 0);
+
+	// Muda a gerao para invalidar os identificadores antigos do ndice
+	s->generation[i]++;
+	s->free_list[s->free_count++] = i;
+}
+
+#if ENTITIES_USE_SSE
+// Mscara de faixa para cada combinao de 4 bits de atividade (constante, ento pode ser lida
+// por vrias threads ao mesmo tempo)
+#define LANE(m) { (m) & 1 ? ~0u : 0u, (m) & 2 ? ~0u : 0u, (m) & 4 ? ~0u : 0u, (m) & 8 ? ~0u : 0u }
+static ENTITY_ALIGNED const uint32_t lane_masks[16][4] = {
+	LANE(0), LANE(1), LANE(2), LANE(3), LANE(4), LANE(5), LANE(6), LANE(7),
+	LANE(8), LANE(9), LANE(10), LANE(11), LANE(12), LANE(13), LANE(14), LANE(15)
+};
+#endif
+
+// Constantes de um passo de integrao, calculadas uma vez por chamada
+struct Step {
+	real_t step; // Durao do passo
+	real_t dv; // Variao da velocidade vertical no passo
+	real_t dy; // Deslocamento vertical devido  gravidade no passo
+	real_t width; // Largura da janela grfica
+	real_t height; // Altura da janela grfica
+};
+
+static void step_init(struct Step* c, float gravity, float dt, float width, float height) {
+	c->step = real_from_float(dt);
+	c->dv = real_mul(real_from_float(gravity), c->step);
+	c->dy = real_mul(real_mul(real_from_float(0.5f * gravity), c->step), c->step);
+	c->width = real_from_float(width);
+	c->height = real_from_float(height);
+}
+
+// Funo que avana as entidades ativas da palavra k da mscara um passo (kernel de integrao)
+// e retorna a mscara das que saram da janela grfica, sem liber-las
+static uint32_t integrate_word(struct EntityStore* s, const struct Step* c, int k) {
+	uint32_t live = s->active[k];
+	uint32_t out = 0;
+	int base = k * ENTITY_MASK_BITS;
+
+	// Pula blocos inteiros sem nenhuma entidade ativa
+	if (live == 0) {
+		return 0;
+	}
+
+#if ENTITIES_USE_SSE
+	const __m128 t = _mm_set1_ps(c->step);
+	const __m128 g = _mm_set1_ps(c->dv);
+	const __m128 d = _mm_set1_ps(c->dy);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 w = _mm_set1_ps(c->width);
+	const __m128 h = _mm_set1_ps(c->height);
+
+	// Processa o bloco em grupos de 4 entidades, atualizando s as faixas ativas
+	for (int j = 0; j < ENTITY_MASK_BITS; j += 4) {
+		int i = base + j;
+		uint32_t nibble = (live >> j) & 0xF;
+		__m128 m, x, y, vx, vy, nx, ny, oob;
+
+		if (nibble == 0) {
+			continue;
+		}
+
+		m = _mm_load_ps((const float*)lane_masks[nibble]);
+		x = _mm_load_ps(s->x + i);
+		y = _mm_load_ps(s->y + i);
+		vx = _mm_load_ps(s->vx + i);
+		vy = _mm_load_ps(s->vy + i);
+
+		// Atualiza a posio de acordo com a velocidade e a velocidade de acordo com a gravidade
+		nx = _mm_add_ps(x, _mm_mul_ps(vx, t));
+		ny = _mm_add_ps(y, _mm_add_ps(_mm_mul_ps(vy, t), d));
+		_mm_store_ps(s->x + i, _mm_or_ps(_mm_and_ps(m, nx), _mm_andnot_ps(m, x)));
+		_mm_store_ps(s->y + i, _mm_or_ps(_mm_and_ps(m, ny), _mm_andnot_ps(m, y)));
+		_mm_store_ps(s->vy + i, _mm_add_ps(vy, _mm_and_ps(m, g)));
+
+		// Verifica quais entidades saram da janela grfica
+		oob = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(nx, zero), _mm_cmpgt_ps(nx, w)),
+			_mm_or_ps(_mm_cmplt_ps(ny, zero), _mm_cmpgt_ps(ny, h)));
+		out |= (uint32_t)_mm_movemask_ps(oob) << j;
+	}
+#else
+	// Verso escalar sem desvios, que o compilador consegue vetorizar sozinho (tambm em ponto fixo)
+	for (int j = 0; j < ENTITY_MASK_BITS; j++) {
+		int i = base + j;
+		int on = (live >> j) & 1;
+		real_t nx = s->x[i] + real_mul(s->vx[i], c->step);
+		real_t ny = s->y[i] + (real_mul(s->vy[i], c->step) + c->dy);
+
+		s->x[i] = on ? nx : s->x[i];
+		s->y[i] = on ? ny : s->y[i];
+		s->vy[i] += on ? c->dv : 0;
+		out |= (uint32_t)(nx < 0 || nx > c->width || ny < 0 || ny > c->height) << j;
+	}
+#endif
+
+	return out & live;
+}
+
+void entities_integrate(struct EntityStore* s, float gravity, float dt, float width, float height) {
+	int words = s->capacity / ENTITY_MASK_BITS;
+	struct Step c;
+
+	step_init(&c, gravity, dt, width, height);
+	for (int k = 0; k < words; k++) {
+		// Libera as entidades que saram da janela grfica
+		uint32_t out = integrate_word(s, &c, k);
+
+		while (out) {
+			entities_release(s, k * ENTITY_MASK_BITS + entities_ctz(out));
+			out &= out - 1;
+		}
+	}
+}
+
+void entities_integrate_words(struct EntityStore* s, float gravity, float dt, float width, float height,
+	int first, int last, uint32_t* exited) {
+	struct Step c;
+
+	step_init(&c, gravity, dt, width, height);
+	for (int k = first; k < last; k++) {
+		exited[k] = integrate_word(s, &c, k);
+	}
+}
+
+void entities_release_mask(struct EntityStore* s, const uint32_t* mask, int first, int last) {
+	for (int k = first; k < last; k++) {
+		uint32_t bits = mask[k];
+
+		while (bits) {
+			entities_release(s, k * ENTITY_MASK_BITS + entities_ctz(bits));
+			bits &= bits - 1;
+		}
+	}
+}
@@ -0,0 +1,166 @@
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include <stdint.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "real.h"
+
+// Alinhamento (em bytes) dos vetores do armazenamento de entidades
+#define ENTITY_ALIGN 32
+// Nmero de entidades representadas por cada palavra da mscara de ativos
+#define ENTITY_MASK_BITS 32
+
+// Arredonda uma capacidade para um nmero inteiro de palavras da mscara
+#define ENTITY_ROUND_CAPACITY(n) ((((n) + ENTITY_MASK_BITS - 1) / ENTITY_MASK_BITS) * ENTITY_MASK_BITS)
+
+// Nmero de bytes necessrios para guardar n entidades (instantes de impacto, posies e velocidades,
+// vetores de float, lista livre, flags, geraes, reas de impacto e mscara)
+#define ENTITY_STORE_BYTES(n) (ENTITY_ROUND_CAPACITY(n) * (sizeof(double) + 4 * sizeof(real_t) + 2 * sizeof(float) + sizeof(int32_t) \
+	+ sizeof(int16_t) + 2 * sizeof(uint8_t)) \
+	+ ENTITY_ROUND_CAPACITY(n) / 8)
+
+// Identificador de uma entidade: ndice nos 24 bits baixos e gerao do ndice nos 8 bits altos.
+// Quando o ndice  liberado e reutilizado a gerao muda, ento identificadores antigos deixam de valer.
+typedef uint32_t EntityHandle;
+
+#define ENTITY_NONE ((EntityHandle)0xFFFFFFFF) // Identificador que no corresponde a nenhuma entidade
+#define ENTITY_INDEX(h) ((int)((h) & 0xFFFFFF)) // ndice de um identificador
+
+#if defined(_MSC_VER)
+#define ENTITY_ALIGNED __declspec(align(ENTITY_ALIGN))
+#else
+#define ENTITY_ALIGNED __attribute__((aligned(ENTITY_ALIGN)))
+#endif
+
+// Usa o kernel SSE quando o alvo garante SSE2 (x86-64 ou -msse2). Em ponto fixo o kernel 
+// sempre o escalar, em inteiros.
+#if !defined(ENTITIES_USE_SSE)
+#if !SIM_FIXED_POINT && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ENTITIES_USE_SSE 1
+#else
+#define ENTITIES_USE_SSE 0
+#endif
+#endif
+
+#if ENTITIES_USE_SSE && SIM_FIXED_POINT
+#error "o kernel SSE no tem verso em ponto fixo"
+#endif
+
+// Armazenamento de entidades (msseis ou interceptores) em estrutura de vetores.
+// Cada campo fica num vetor contguo e alinhado, e a mscara "active" guarda um bit por entidade.
+// Os ndices livres ficam numa pilha, ento alocar e liberar uma entidade custa O(1).
+struct EntityStore {
+	int capacity; // Capacidade do armazenamento (mltiplo de ENTITY_MASK_BITS)
+	double* impact_time; // Instantes previstos do fim da trajetria (impacto numa rea ou sada da janela)
+	real_t* x; // Posies x
+	real_t* y; // Posies y
+	real_t* vx; // Velocidades x
+	real_t* vy; // Velocidades y
+	float* angle; // ngulos de lanamento
+	float* speed; // Velocidades de lanamento
+	int32_t* free_list; // Pilha de ndices livres
+	uint8_t* targeted; // Indica se a entidade est direcionada a uma rea habitada
+	uint8_t* generation; // Gerao atual de cada ndice
+	int16_t* impact_area; // rea habitada atingida no fim da trajetria, ou -1 se nenhuma
+	uint32_t* active; // Mscara de bits das entidades ativas
+	int free_count; // Nmero de ndices na pilha de livres
+};
+
+// Inicializa o armazenamento sobre um buffer de ENTITY_STORE_BYTES(capacity) bytes alinhado em ENTITY_ALIGN
+void entities_init(struct EntityStore* s, int capacity, void* buffer);
+
+// Reserva um ndice livre e retorna o seu identificador, ou ENTITY_NONE se no houver.
+// A entidade ainda no fica ativa: quem aloca preenche os campos e chama entities_set_active.
+EntityHandle entities_alloc(struct EntityStore* s);
+
+// Desativa a entidade i e devolve o seu ndice para a lista de livres
+void entities_release(struct EntityStore* s, int i);
+
+// Avana todas as entidades ativas dt segundos e libera as que saram da janela grfica.
+// O passo  exato para acelerao constante, ento o resultado no depende do tamanho de dt.
+void entities_integrate(struct EntityStore* s, float gravity, float dt, float width, float height);
+
+// Mesmo passo de entities_integrate s para as palavras [first, last) da mscara e sem liberar
+// ningum: as entidades que saram da janela ficam em exited[first..last). Intervalos disjuntos
+// podem ser avanados por threads diferentes ao mesmo tempo.
+void entities_integrate_words(struct EntityStore* s, float gravity, float dt, float width, float height,
+	int first, int last, uint32_t* exited);
+
+// Libera, em ordem crescente de ndice, as entidades marcadas nas palavras [first, last) de mask
+void entities_release_mask(struct EntityStore* s, const uint32_t* mask, int first, int last);
+
+// Retorna o identificador atual do ndice i
+static inline EntityHandle entities_handle(const struct EntityStore* s, int i) {
+	return ((EntityHandle)s->generation[i] << 24) | (EntityHandle)i;
+}
+
+// Verifica se um identificador ainda se refere a uma entidade ativa
+static inline int entities_valid(const struct EntityStore* s, EntityHandle h) {
+	int i = ENTITY_INDEX(h);
+	return h != ENTITY_NONE && i < s->capacity && entities_handle(s, i) == h
+		&& ((s->active[i / ENTITY_MASK_BITS] >> (i % ENTITY_MASK_BITS)) & 1);
+}
+
+// Retorna o ndice do bit menos significativo ligado de uma palavra no nula
+static inline int entities_ctz(uint32_t bits) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+// Retorna o nmero de bits ligados de uma palavra
+static inline int entities_popcount(uint32_t bits) {
+#if defined(_MSC_VER)
+	return (int)__popcnt(bits);
+#else
+	return __builtin_popcount(bits);
+#endif
+}
+
+// Verifica se a entidade i est ativa
+static inline int entities_is_active(const struct EntityStore* s, int i) {
+	return (s->active[i / ENTITY_MASK_BITS] >> (i % ENTITY_MASK_BITS)) & 1;
+}
+
+// Ativa ou desativa a entidade i
+static inline void entities_set_active(struct EntityStore* s, int i, int on) {
+	uint32_t bit = (uint32_t)1 << (i % ENTITY_MASK_BITS);
+
+	if (on) {
+		s->active[i / ENTITY_MASK_BITS] |= bit;
+	}
+	else {
+		s->active[i / ENTITY_MASK_BITS] &= ~bit;
+	}
+}
+
+// Retorna o ndice da prxima entidade ativa a partir de i (inclusive), ou -1 se no houver
+static inline int entities_next_active(const struct EntityStore* s, int i) {
+	int w = i / ENTITY_MASK_BITS;
+	int words = s->capacity / ENTITY_MASK_BITS;
+	uint32_t bits;
+
+	if (i >= s->capacity) {
+		return -1;
+	}
+
+	// Descarta os bits anteriores a i na primeira palavra
+	bits = s->active[w] & (~(uint32_t)0 << (i % ENTITY_MASK_BITS));
+	while (bits == 0) {
+		if (++w >= words) {
+			return -1;
+		}
+		bits = s->active[w];
+	}
+
+	return w * ENTITY_MASK_BITS + entities_ctz(bits);
+}
+
+#endif
@@ -0,0 +1,414 @@
+#include <math.h>
+
+#include "ballistics.h"
+#include "events.h"
+
+// Passo que nunca chega, usado para trajetrias que no terminam
+#define EVENT_NEVER INT64_MAX
+
+// Slots fixos de cada evento
+#define SLOT_MISSILE(j) (j)
+#define SLOT_INTERCEPTOR_END(i) (e->missiles + (i))
+#define SLOT_INTERCEPT(i) (e->missiles + e->interceptors + (i))
+
+size_t events_arena_bytes(const struct SimConfig* config) {
+	size_t m = ENTITY_ROUND_CAPACITY(config->max_missiles);
+	size_t i = ENTITY_ROUND_CAPACITY(config->max_interceptors);
+	size_t slots = m + 2 * i;
+
+	return ARENA_BYTES(slots * sizeof(struct Event), sizeof(int64_t))
+		+ ARENA_BYTES(slots * sizeof(int), sizeof(int))
+		+ 2 * ARENA_BYTES(m * sizeof(int64_t), sizeof(int64_t))
+		+ 2 * ARENA_BYTES(i * sizeof(int64_t), sizeof(int64_t));
+}
+
+int events_create(struct EventEngine* e, const struct SimConfig* config, struct Arena* arena) {
+	// Usa as mesmas capacidades arredondadas que entities_init d aos armazenamentos
+	int m = ENTITY_ROUND_CAPACITY(config->max_missiles);
+	int i = ENTITY_ROUND_CAPACITY(config->max_interceptors);
+	size_t slots = (size_t)m + 2 * (size_t)i;
+
+	e->missiles = m;
+	e->interceptors = i;
+	e->heap = arena_alloc(arena, slots * sizeof(struct Event), sizeof(int64_t));
+	e->position = arena_alloc(arena, slots * sizeof(int), sizeof(int));
+	e->missile_base = arena_alloc(arena, m * sizeof(int64_t), sizeof(int64_t));
+	e->missile_end = arena_alloc(arena, m * sizeof(int64_t), sizeof(int64_t));
+	e->interceptor_base = arena_alloc(arena, i * sizeof(int64_t), sizeof(int64_t));
+	e->interceptor_end = arena_alloc(arena, i * sizeof(int64_t), sizeof(int64_t));
+
+	if (e->heap == NULL || e->position == NULL || e->missile_base == NULL || e->missile_end == NULL
+		|| e->interceptor_base == NULL || e->interceptor_end == NULL) {
+		return -1;
+	}
+	return 0;
+}
+
+// Funo que compara dois eventos pela ordem (tick, phase, slot)
+static int event_before(const struct Event* a, const struct Event* b) {
+	if (a->tick != b->tick) {
+		return a->tick < b->tick;
+	}
+	if (a->phase != b->phase) {
+		return a->phase < b->phase;
+	}
+	return a->slot < b->slot;
+}
+
+// Funo que coloca o evento ev na posio k do heap, atualizando o ndice de posies
+static void heap_put(struct EventEngine* e, int k, struct Event ev) {
+	e->heap[k] = ev;
+	e->position[ev.slot] = k;
+}
+
+static void heap_up(struct EventEngine* e, int k) {
+	struct Event ev = e->heap[k];
+
+	while (k > 0 && event_before(&ev, &e->heap[(k - 1) / 2])) {
+		heap_put(e, k, e->heap[(k - 1) / 2]);
+		k = (k - 1) / 2;
+	}
+	heap_put(e, k, ev);
+}
+
+static void heap_down(struct EventEngine* e, int k) {
+	struct Event ev = e->heap[k];
+
+	for (;;) {
+		int c = 2 * k + 1;
+
+		if (c >= e->size) {
+			break;
+		}
+		if (c + 1 < e->size && event_before(&e->heap[c + 1], &e->heap[c])) {
+			c++;
+		}
+		if (!event_before(&e->heap[c], &ev)) {
+			break;
+		}
+		heap_put(e, k, e->heap[c]);
+		k = c;
+	}
+	heap_put(e, k, ev);
+}
+
+// Funo que retira o slot da fila, se estiver agendado
+static void unschedule(struct EventEngine* e, int slot) {
+	int k = e->position[slot];
+
+	if (k < 0) {
+		return;
+	}
+
+	e->position[slot] = -1;
+	if (--e->size == k) {
+		return;
+	}
+
+	// O ltimo evento ocupa o lugar do retirado e sobe ou desce at a sua posio
+	int moved = e->heap[e->size].slot;
+	heap_put(e, k, e->heap[e->size]);
+	heap_up(e, k);
+	heap_down(e, e->position[moved]);
+}
+
+// Funo que agenda (ou reagenda) o slot para o passo tick; EVENT_NEVER apenas o retira da fila
+static void schedule(struct EventEngine* e, int slot, int phase, int64_t tick) {
+	struct Event ev;
+	int k = e->position[slot];
+
+	if (tick == EVENT_NEVER) {
+		unschedule(e, slot);
+		return;
+	}
+
+	ev.tick = tick;
+	ev.phase = phase;
+	ev.slot = slot;
+
+	if (k < 0) {
+		k = e->size++;
+	}
+	heap_put(e, k, ev);
+	heap_up(e, k);
+	heap_down(e, e->position[slot]);
+}
+
+// Funo que calcula o estado da entidade i do armazenamento s no passo tick, a partir do estado
+// guardado para o passo base
+static void state_at(const struct EventEngine* e, const struct EntityStore* s, int i, int64_t base, int64_t tick,
+	double* x, double* y, double* vx, double* vy) {
+	double t = (double)(tick - base) * e->dt;
+
+	*x = real_to_double(s->x[i]) + real_to_double(s->vx[i]) * t;
+	*y = real_to_double(s->y[i]) + real_to_double(s->vy[i]) * t + 0.5 * GRAVITY * t * t;
+	*vx = real_to_double(s->vx[i]);
+	*vy = real_to_double(s->vy[i]) + GRAVITY * t;
+}
+
+// Funo que calcula o primeiro passo depois de base em que a entidade est fora da janela grfica
+static int64_t exit_tick(const struct EventEngine* e, const struct EntityStore* s, int i, int64_t base) {
+	double t = ballistic_window_exit(real_to_float(s->x[i]), real_to_float(s->y[i]), real_to_float(s->vx[i]), real_to_float(s->vy[i]),
+		GRAVITY, e->sim->config.width, e->sim->config.height);
+
+	if (t == HUGE_VAL) {
+		return EVENT_NEVER;
+	}
+
+	// Em t a entidade ainda est na borda; update() s a libera no primeiro passo depois disso
+	return base + (int64_t)floor(t / e->dt) + 1;
+}
+
+// Funo que agenda o fim da trajetria do mssil j, colocado no passo atual: a sada da janela ou,
+// se acontecer antes, o impacto na rea prevista no lanamento
+static void schedule_missile(struct EventEngine* e, int j) {
+	struct EntityStore* s = &e->sim->missiles;
+	int64_t exit = exit_tick(e, s, j, e->tick);
+	int64_t impact = EVENT_NEVER;
+
+	if (s->impact_area[j] >= 0) {
+		// update() conta o impacto no primeiro passo em que o tempo alcana o instante previsto
+		double wait = ceil((s->impact_time[j] - e->sim->time) / e->dt);
+		impact = e->tick + (wait < 1 ? 1 : (int64_t)wait);
+	}
+
+	e->missile_base[j] = e->tick;
+	if (impact < exit) {
+		e->missile_end[j] = impact;
+		schedule(e, SLOT_MISSILE(j), EVENT_IMPACT, impact);
+	}
+	else {
+		// Se os dois caem no mesmo passo, entities_integrate libera o mssil antes da verificao
+		// de impactos, ento ele s sai da janela
+		e->missile_end[j] = exit;
+		schedule(e, SLOT_MISSILE(j), EVENT_EXIT, exit);
+	}
+}
+
+// Funo que calcula o primeiro passo a partir de from em que o interceptor i e o mssil j passaram
+// a no mximo INTERCEPT_TOLERANCE em algum instante do passo, com os dois ainda ativos. Como os dois
+// esto sob a mesma gravidade, o movimento relativo  linear e a distncia ao quadrado  um
+// polinmio de segundo grau no tempo.
+static int64_t contact_tick(const struct EventEngine* e, int i, int j, int64_t from) {
+	const struct EntityStore* is = &e->sim->interceptors;
+	const struct EntityStore* ms = &e->sim->missiles;
+	int64_t bi = e->interceptor_base[i];
+	int64_t bj = e->missile_base[j];
+	int64_t ref = bi > bj ? bi : bj;
+	int64_t first, last;
+	double xi, yi, vxi, vyi, xj, yj, vxj, vyj;
+	double dx, dy, dvx, dvy, a, b, c, disc, s1, s2;
+
+	// Os dois s so testados a partir do passo seguinte ao lanamento e at o passo anterior ao fim
+	first = from;
+	first = first > bi + 1 ? first : bi + 1;
+	first = first > bj + 1 ? first : bj + 1;
+	last = e->interceptor_end[i] < e->missile_end[j] ? e->interceptor_end[i] : e->missile_end[j];
+	if (last != EVENT_NEVER) {
+		last--;
+	}
+	if (first > last) {
+		return EVENT_NEVER;
+	}
+
+	state_at(e, is, i, bi, ref, &xi, &yi, &vxi, &vyi);
+	state_at(e, ms, j, bj, ref, &xj, &yj, &vxj, &vyj);
+	dx = xi - xj;
+	dy = yi - yj;
+	dvx = vxi - vxj;
+	dvy = vyi - vyj;
+
+	// |d + dv s| <= tolerncia, com s medido a partir do passo ref
+	a = dvx * dvx + dvy * dvy;
+	b = 2 * (dx * dvx + dy * dvy);
+	c = dx * dx + dy * dy - INTERCEPT_TOLERANCE * INTERCEPT_TOLERANCE;
+	if (a == 0) {
+		return c <= 0 ? first : EVENT_NEVER;
+	}
+
+	disc = b * b - 4 * a * c;
+	if (disc < 0) {
+		return EVENT_NEVER;
+	}
+	s1 = (-b - sqrt(disc)) / (2 * a);
+	s2 = (-b + sqrt(disc)) / (2 * a);
+
+	// O passo k cobre o intervalo [(k - 1 - ref) dt, (k - ref) dt], e detecta o contato se esse
+	// intervalo encontra [s1, s2]
+	if (s2 < (double)(first - 1 - ref) * e->dt) {
+		return EVENT_NEVER;
+	}
+	if (s1 > (double)(first - ref) * e->dt) {
+		int64_t k = ref + (int64_t)ceil(s1 / e->dt);
+		first = k > first ? k : first;
+	}
+	if ((double)(first - 1 - ref) * e->dt > s2 || first > last) {
+		return EVENT_NEVER;
+	}
+	return first;
+}
+
+// Funo que agenda a prxima interceptao possvel do interceptor i a partir do passo from
+static void schedule_interceptor(struct EventEngine* e, int i, int64_t from) {
+	struct EntityStore* ms = &e->sim->missiles;
+	int64_t best = EVENT_NEVER;
+
+	for (int j = entities_next_active(ms, 0); j >= 0; j = entities_next_active(ms, j + 1)) {
+		if (ms->targeted[j]) {
+			int64_t k = contact_tick(e, i, j, from);
+			best = k < best ? k : best;
+		}
+	}
+
+	schedule(e, SLOT_INTERCEPT(i), EVENT_INTERCEPT, best);
+}
+
+void events_init(struct EventEngine* e, struct Simulation* sim, float dt) {
+	e->sim = sim;
+	e->dt = dt;
+	e->tick = 0;
+	e->base_time = sim->time;
+	e->processed = 0;
+	e->size = 0;
+	for (int k = 0; k < e->missiles + 2 * e->interceptors; k++) {
+		e->position[k] = -1;
+	}
+
+	// Adota as entidades que j esto em voo, com o estado atual do armazenamento
+	for (int j = entities_next_active(&sim->missiles, 0); j >= 0; j = entities_next_active(&sim->missiles, j + 1)) {
+		schedule_missile(e, j);
+	}
+	for (int i = entities_next_active(&sim->interceptors, 0); i >= 0; i = entities_next_active(&sim->interceptors, i + 1)) {
+		e->interceptor_base[i] = e->tick;
+		e->interceptor_end[i] = exit_tick(e, &sim->interceptors, i, e->tick);
+		schedule(e, SLOT_INTERCEPTOR_END(i), EVENT_EXIT, e->interceptor_end[i]);
+	}
+	for (int i = entities_next_active(&sim->interceptors, 0); i >= 0; i = entities_next_active(&sim->interceptors, i + 1)) {
+		schedule_interceptor(e, i, e->tick + 1);
+	}
+}
+
+EntityHandle events_launch_missile(struct EventEngine* e, const struct LaunchDescriptor* d) {
+	struct EntityStore* is = &e->sim->interceptors;
+	EntityHandle h = launch_missile(e->sim, d);
+	int j = ENTITY_INDEX(h);
+
+	if (h == ENTITY_NONE) {
+		return h;
+	}
+
+	schedule_missile(e, j);
+
+	// Um novo alvo pode antecipar a prxima interceptao de cada interceptor
+	if (e->sim->missiles.targeted[j]) {
+		for (int i = entities_next_active(is, 0); i >= 0; i = entities_next_active(is, i + 1)) {
+			int64_t k = contact_tick(e, i, j, e->tick + 1);
+			int p = e->position[SLOT_INTERCEPT(i)];
+
+			if (k != EVENT_NEVER && (p < 0 || k < e->heap[p].tick)) {
+				schedule(e, SLOT_INTERCEPT(i), EVENT_INTERCEPT, k);
+			}
+		}
+	}
+	return h;
+}
+
+EntityHandle events_launch_interceptor(struct EventEngine* e, const struct LaunchDescriptor* d) {
+	EntityHandle h = launch_interceptor(e->sim, d);
+	int i = ENTITY_INDEX(h);
+
+	if (h == ENTITY_NONE) {
+		return h;
+	}
+
+	e->interceptor_base[i] = e->tick;
+	e->interceptor_end[i] = exit_tick(e, &e->sim->interceptors, i, e->tick);
+	schedule(e, SLOT_INTERCEPTOR_END(i), EVENT_EXIT, e->interceptor_end[i]);
+	schedule_interceptor(e, i, e->tick + 1);
+	return h;
+}
+
+// Funo que processa a interceptao agendada para o interceptor i no passo tick. Como em
+// update(), o interceptor derruba o mssil de menor ndice que est ao seu alcance nesse passo.
+static void intercept(struct EventEngine* e, int i, int64_t tick) {
+	struct Simulation* sim = e->sim;
+	struct EntityStore* ms = &sim->missiles;
+
+	for (int j = entities_next_active(ms, 0); j >= 0; j = entities_next_active(ms, j + 1)) {
+		if (ms->targeted[j] && contact_tick(e, i, j, tick) == tick) {
+			// Atualiza o nmero de msseis que foram interceptados
+			stats_add(&sim->counters, STATS_MONITOR, STATS_INTERCEPTS, 1);
+
+			// Desativa o mssil e o interceptor e devolve os seus ndices
+			entities_release(ms, j);
+			unschedule(e, SLOT_MISSILE(j));
+			entities_release(&sim->interceptors, i);
+			unschedule(e, SLOT_INTERCEPTOR_END(i));
+			return;
+		}
+	}
+
+	// O alvo previsto j foi derrubado ou caiu: procura o prximo encontro
+	schedule_interceptor(e, i, tick + 1);
+}
+
+void events_advance(struct EventEngine* e, int steps) {
+	struct Simulation* sim = e->sim;
+	int64_t target = e->tick + steps;
+
+	while (e->size > 0 && e->heap[0].tick <= target) {
+		struct Event ev = e->heap[0];
+
+		unschedule(e, ev.slot);
+		e->processed++;
+
+		if (ev.slot < e->missiles) {
+			int j = ev.slot;
+
+			if (ev.phase == EVENT_IMPACT) {
+				// Marca a rea como atingida e atualiza o nmero de msseis que atingiram as reas
+				sim->areas[sim->missiles.impact_area[j]].hit = 1;
+				stats_add(&sim->counters, STATS_MONITOR, STATS_HITS, 1);
+			}
+			entities_release(&sim->missiles, j);
+		}
+		else if (ev.slot < e->missiles + e->interceptors) {
+			int i = ev.slot - e->missiles;
+
+			entities_release(&sim->interceptors, i);
+			unschedule(e, SLOT_INTERCEPT(i));
+		}
+		else {
+			intercept(e, ev.slot - e->missiles - e->interceptors, ev.tick);
+		}
+	}
+
+	// O relgio  calculado a partir do passo, ento um salto custa o mesmo qualquer que seja o
+	// nmero de passos saltados. Difere de somar dt a cada passo, como update(), s no arredondamento.
+	e->tick = target;
+	sim->time = e->base_time + (double)target * e->dt;
+}
+
+void events_sync(struct EventEngine* e) {
+	struct Simulation* sim = e->sim;
+	struct EntityStore* ms = &sim->missiles;
+	struct EntityStore* is = &sim->interceptors;
+	double x, y, vx, vy;
+
+	for (int j = entities_next_active(ms, 0); j >= 0; j = entities_next_active(ms, j + 1)) {
+		state_at(e, ms, j, e->missile_base[j], e->tick, &x, &y, &vx, &vy);
+		ms->x[j] = real_from_double(x);
+		ms->y[j] = real_from_double(y);
+		ms->vy[j] = real_from_double(vy);
+		e->missile_base[j] = e->tick;
+	}
+	for (int i = entities_next_active(is, 0); i >= 0; i = entities_next_active(is, i + 1)) {
+		state_at(e, is, i, e->interceptor_base[i], e->tick, &x, &y, &vx, &vy);
+		is->x[i] = real_from_double(x);
+		is->y[i] = real_from_double(y);
+		is->vy[i] = real_from_double(vy);
+		e->interceptor_base[i] = e->tick;
+	}
+
+	grid_sync(&sim->missile_grid, ms);
+}
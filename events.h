@@ -0,0 +1,73 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "simulation.h"
+
+// Fases de um passo, na mesma ordem em que update() as executa
+enum EventPhase {
+	EVENT_EXIT, // Sada da janela grfica (entities_integrate)
+	EVENT_IMPACT, // Impacto de um mssil numa rea habitada
+	EVENT_INTERCEPT // Interceptao de um mssil por um interceptor
+};
+
+// Evento agendado. A ordem  (tick, phase, slot): dentro de uma fase, o slot segue o ndice da
+// entidade, que  a ordem em que update() percorre os armazenamentos.
+struct Event {
+	int64_t tick; // Passo em que o evento acontece
+	int phase; // Fase do passo
+	int slot; // Posio fixa do evento (mssil, fim do interceptor ou interceptao)
+};
+
+// Motor de eventos discretos. Usa a mesma struct Simulation do motor por passos, mas em vez de
+// integrar todas as entidades a cada passo guarda o estado de lanamento de cada uma e calcula
+// analiticamente o passo da sada da janela, do impacto e da interceptao, saltando de um
+// evento para o prximo. Os eventos caem nos mesmos passos em que update() os detectaria, ento
+// os resultados so os mesmos, exceto em casos de fronteira decididos pelo arredondamento em float.
+// Com SIM_FIXED_POINT as trajetrias continuam sendo calculadas em double a partir do estado em
+// Q16.16, ento o motor s se aproxima do motor por passos, que arredonda em ponto fixo a cada passo.
+struct EventEngine {
+	struct Simulation* sim; // Simulao avanada pelo motor
+	float dt; // Passo fixo (o mesmo que seria passado para update)
+	int64_t tick; // Passo atual; sim->time corresponde a ele
+	double base_time; // sim->time no passo 0, em events_init; sim->time = base_time + tick * dt
+	int64_t processed; // Nmero de eventos processados
+	int missiles; // Capacidade do armazenamento de msseis
+	int interceptors; // Capacidade do armazenamento de interceptores
+	int size; // Nmero de eventos na fila
+	// Cada entidade tem no mximo um evento de fim de trajetria e cada interceptor mais um de
+	// interceptao, ento a fila tem uma posio fixa (slot) para cada um deles
+	struct Event* heap; // Fila de prioridade (heap binrio)
+	int* position; // Posio de cada slot no heap, ou -1 se no est agendado
+	int64_t* missile_base; // Passo a que se refere o estado de cada mssil no armazenamento
+	int64_t* missile_end; // Passo em que cada mssil sai da janela ou atinge uma rea
+	int64_t* interceptor_base; // Passo a que se refere o estado de cada interceptor
+	int64_t* interceptor_end; // Passo em que cada interceptor sai da janela
+};
+
+// Calcula quantos bytes de arena events_create usa para uma configurao
+size_t events_arena_bytes(const struct SimConfig* config);
+
+// Reserva na arena a memria do motor para as capacidades da configurao. Retorna 0 se conseguiu.
+int events_create(struct EventEngine* e, const struct SimConfig* config, struct Arena* arena);
+
+// Inicializa o motor sobre uma simulao j inicializada, agendando as entidades que j esto ativas
+void events_init(struct EventEngine* e, struct Simulation* sim, float dt);
+
+// Lana um mssil ou um interceptor no passo atual (como launch_missile e launch_interceptor)
+// e agenda os seus eventos
+EntityHandle events_launch_missile(struct EventEngine* e, const struct LaunchDescriptor* d);
+EntityHandle events_launch_interceptor(struct EventEngine* e, const struct LaunchDescriptor* d);
+
+// Avana steps passos, processando todos os eventos at l. Equivale a chamar update(sim, dt)
+// steps vezes, mas o custo depende do nmero de eventos e no do nmero de passos e entidades.
+void events_advance(struct EventEngine* e, int steps);
+
+// Escreve no armazenamento o estado atual de todas as entidades ativas e atualiza a grade,
+// para que a simulao possa continuar com update() ou ser desenhada
+void events_sync(struct EventEngine* e);
+
+#endif
@@ -0,0 +1,138 @@
+#include <math.h>
+
+#include "fastmath.h"
+#include "real.h"
+
+#if SIM_FIXED_POINT
+
+void fm_sincos(float x, float* s, float* c) {
+	fixed_t fs, fc;
+
+	fx_sincos(fx_from_double(x), &fs, &fc);
+	*s = (float)fx_to_double(fs);
+	*c = (float)fx_to_double(fc);
+}
+
+void fm_sincos_deg(float degrees, float* s, float* c) {
+	fixed_t fs, fc;
+
+	fx_sincos_deg(fx_from_double(degrees), &fs, &fc);
+	*s = (float)fx_to_double(fs);
+	*c = (float)fx_to_double(fc);
+}
+
+float fm_atan2(float y, float x) {
+	return (float)fx_to_double(fx_atan2(fx_from_double(y), fx_from_double(x)));
+}
+
+#elif FASTMATH_USE_LIBM
+
+void fm_sincos(float x, float* s, float* c) {
+	*s = (float)sin(x);
+	*c = (float)cos(x);
+}
+
+void fm_sincos_deg(float degrees, float* s, float* c) {
+	double radians = degrees * (FM_PI / 180);
+
+	*s = (float)sin(radians);
+	*c = (float)cos(radians);
+}
+
+float fm_atan2(float y, float x) {
+	return (float)atan2(y, x);
+}
+
+#else
+
+// Polinmios mnimos (coeficientes da Cephes) para seno e cosseno em [-pi/4, pi/4]
+static inline float sin_poly(float x) {
+	float z = x * x;
+	return ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+}
+
+static inline float cos_poly(float x) {
+	float z = x * x;
+	return ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+}
+
+// Combina os polinmios de acordo com o quadrante q (o ngulo original  r + q pi/2)
+static inline void quadrant(float r, int q, float* s, float* c) {
+	float ps = sin_poly(r);
+	float pc = cos_poly(r);
+
+	switch (q & 3) {
+	case 0: *s = ps; *c = pc; break;
+	case 1: *s = pc; *c = -ps; break;
+	case 2: *s = -ps; *c = -pc; break;
+	default: *s = -pc; *c = ps; break;
+	}
+}
+
+void fm_sincos(float x, float* s, float* c) {
+	// Reduo de Cody-Waite: x = r + q pi/2, com pi/2 dividido em trs partes exatas em float
+	int q = (int)lrintf(x * (float)(2 / FM_PI));
+	float r = ((x - q * 1.5703125f) - q * 4.837512969970703125e-4f) - q * 7.54978995489188216e-8f;
+
+	quadrant(r, q, s, c);
+}
+
+void fm_sincos_deg(float degrees, float* s, float* c) {
+	// Em graus a reduo  exata: r fica em [-45, 45] e s ento  convertido para radianos
+	int q = (int)lrintf(degrees * (1.0f / 90));
+	float r = (degrees - q * 90.0f) * (float)(FM_PI / 180);
+
+	quadrant(r, q, s, c);
+}
+
+float fm_atan2(float y, float x) {
+	float ax = fabsf(x);
+	float ay = fabsf(y);
+	float mx = ax > ay ? ax : ay;
+	float mn = ax > ay ? ay : ax;
+	float a, z, r, base = 0;
+
+	// Reduz para a em [0, tan(pi/8)]: acima disso usa atan(a) = pi/4 + atan((a - 1) / (a + 1))
+	a = mx > 0 ? mn / mx : 0;
+	if (a > 0.4142135623730950f) {
+		a = (a - 1) / (a + 1);
+		base = (float)(FM_PI / 4);
+	}
+
+	z = a * a;
+	r = base + ((((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * a + a);
+
+	// Volta para o octante e o quadrante originais
+	if (ay > ax) {
+		r = (float)(FM_PI / 2) - r;
+	}
+	if (signbit(x)) {
+		r = (float)FM_PI - r;
+	}
+	return signbit(y) ? -r : r;
+}
+
+#endif
+
+void fm_polar_deg_batch(const float* degrees, const float* r, float* x, float* y, int n, float sign_x, float sign_y) {
+#if SIM_FIXED_POINT
+	// Os produtos tambm em Q16.16; o sinal  exato em float
+	fixed_t s, c;
+
+	for (int i = 0; i < n; i++) {
+		fixed_t m = fx_from_double(r[i]);
+
+		fx_sincos_deg(fx_from_double(degrees[i]), &s, &c);
+		x[i] = sign_x * (float)fx_to_double(fx_mul(m, c));
+		y[i] = sign_y * (float)fx_to_double(fx_mul(m, s));
+	}
+#else
+	float s, c;
+
+	for (int i = 0; i < n; i++) {
+		fm_sincos_deg(degrees[i], &s, &c);
+		x[i] = sign_x * r[i] * c;
+		y[i] = sign_y * r[i] * s;
+	}
+#endif
+}
@@ -0,0 +1,29 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+// Trigonometria rpida em float para os lanamentos e a mira.
+// Com FASTMATH_USE_LIBM = 1 todas as funes chamam a libm e do exatamente os mesmos resultados
+// que sin, cos e atan2; com 0 (padro) usam reduo de faixa e polinmios em float, com erro
+// absoluto abaixo de 2e-7 em seno e cosseno e de 3e-7 rad em atan2. Com SIM_FIXED_POINT (real.h)
+// nenhuma das duas vale: as funes usam o CORDIC em Q16.16 de fixed.h, com erro de meia unidade
+// de Q16.16 (8e-6) e resultados idnticos em qualquer mquina.
+#if !defined(FASTMATH_USE_LIBM)
+#define FASTMATH_USE_LIBM 0
+#endif
+
+#define FM_PI 3.14159265358979323846 // Valor de pi com preciso total
+
+// Calcula o seno e o cosseno de x (em radianos)
+void fm_sincos(float x, float* s, float* c);
+
+// Calcula o seno e o cosseno de um ngulo em graus (a reduo de faixa  feita em graus, sem erro)
+void fm_sincos_deg(float degrees, float* s, float* c);
+
+// Calcula o ngulo de (x, y) em radianos, em [-pi, pi]
+float fm_atan2(float y, float x);
+
+// Converte n pares (ngulo em graus, mdulo) em componentes: x = sign_x * r cos(a), y = sign_y * r sin(a).
+// Usado para transformar uma onda inteira de lanamentos em velocidades numa s chamada.
+void fm_polar_deg_batch(const float* degrees, const float* r, float* x, float* y, int n, float sign_x, float sign_y);
+
+#endif
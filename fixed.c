@@ -0,0 +1,165 @@
+#include <math.h>
+
+#include "fixed.h"
+
+// O CORDIC trabalha em Q2.30 com 64 bits, bem acima da preciso de Q16.16
+#define CORDIC_SHIFT 30 // Bits de frao dos ngulos e vetores internos
+#define CORDIC_STEPS 30 // Iteraes (uma por bit)
+#define CORDIC_GAIN 652032874 // Produto de 1 / sqrt(1 + 2^-2i) em Q2.30, compensa o ganho das rotaes
+#define CORDIC_PI 3373259426LL // pi em Q2.30
+#define CORDIC_HALF_PI 1686629713LL // pi / 2 em Q2.30
+#define CORDIC_DEG 18740330LL // pi / 180 em Q2.30
+#define CORDIC_TOP ((int64_t)1 << 40) // Mdulo a partir do qual atan2 para de ampliar o vetor
+
+// atan(2^-i) em Q2.30
+static const int64_t atan_table[CORDIC_STEPS] = {
+	843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851, 8388437,
+	4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768,
+	16384, 8192, 4096, 2048, 1024, 512, 256, 128,
+	64, 32, 16, 8, 4, 2
+};
+
+fixed_t fx_from_double(double v) {
+	double r = floor(v * FX_ONE + 0.5);
+
+	if (r != r) {
+		return 0;
+	}
+	if (r >= (double)INT32_MAX) {
+		return INT32_MAX;
+	}
+	if (r <= (double)INT32_MIN) {
+		return INT32_MIN;
+	}
+	return (fixed_t)r;
+}
+
+uint64_t fx_isqrt64(uint64_t v) {
+	uint64_t r = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	// Mtodo dos dgitos: decide um bit da raiz por iterao, do mais alto para o mais baixo
+	while (bit > v) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (v >= r + bit) {
+			v -= r + bit;
+			r = (r >> 1) + bit;
+		}
+		else {
+			r >>= 1;
+		}
+		bit >>= 2;
+	}
+	return r;
+}
+
+fixed_t fx_sqrt(fixed_t a) {
+	if (a <= 0) {
+		return 0;
+	}
+	return (fixed_t)fx_isqrt64((uint64_t)a << FX_SHIFT);
+}
+
+// Divide arredondando para baixo (b > 0)
+static int64_t floor_div(int64_t a, int64_t b) {
+	int64_t q = a / b;
+	return a % b != 0 && a < 0 ? q - 1 : q;
+}
+
+// Gira o vetor (CORDIC_GAIN, 0) por z radianos em Q2.30, com |z| <= pi/4
+static void rotate(int64_t z, int64_t* s, int64_t* c) {
+	int64_t x = CORDIC_GAIN;
+	int64_t y = 0;
+
+	for (int i = 0; i < CORDIC_STEPS; i++) {
+		int64_t dx = y >> i;
+		int64_t dy = x >> i;
+
+		if (z >= 0) {
+			x -= dx;
+			y += dy;
+			z -= atan_table[i];
+		}
+		else {
+			x += dx;
+			y -= dy;
+			z += atan_table[i];
+		}
+	}
+	*s = y;
+	*c = x;
+}
+
+// Combina a rotao de r com o quadrante q (o ngulo original  r + q pi/2) e volta para Q16.16
+static void quadrant(int64_t r, int64_t q, fixed_t* s, fixed_t* c) {
+	int64_t ps, pc;
+
+	rotate(r, &ps, &pc);
+	ps = fx_round_shift(ps, CORDIC_SHIFT - FX_SHIFT);
+	pc = fx_round_shift(pc, CORDIC_SHIFT - FX_SHIFT);
+
+	switch (q & 3) {
+	case 0: *s = (fixed_t)ps; *c = (fixed_t)pc; break;
+	case 1: *s = (fixed_t)pc; *c = (fixed_t)-ps; break;
+	case 2: *s = (fixed_t)-ps; *c = (fixed_t)-pc; break;
+	default: *s = (fixed_t)-pc; *c = (fixed_t)ps; break;
+	}
+}
+
+void fx_sincos(fixed_t radians, fixed_t* s, fixed_t* c) {
+	int64_t z = (int64_t)radians * ((int64_t)1 << (CORDIC_SHIFT - FX_SHIFT));
+	int64_t q = floor_div(z + CORDIC_HALF_PI / 2, CORDIC_HALF_PI);
+
+	quadrant(z - q * CORDIC_HALF_PI, q, s, c);
+}
+
+void fx_sincos_deg(fixed_t degrees, fixed_t* s, fixed_t* c) {
+	// r fica em [-45, 45) graus e s ento  convertido para radianos
+	int64_t q = floor_div((int64_t)degrees + 45 * FX_ONE, 90 * FX_ONE);
+	int64_t r = (int64_t)degrees - q * 90 * FX_ONE;
+
+	quadrant(fx_round_shift(r * CORDIC_DEG, FX_SHIFT), q, s, c);
+}
+
+fixed_t fx_atan2(fixed_t y, fixed_t x) {
+	int64_t vx = x;
+	int64_t vy = y;
+	int64_t z = 0;
+
+	if (x == 0 && y == 0) {
+		return 0;
+	}
+
+	// Leva o vetor para o semiplano x >= 0, onde o modo vetorial converge, girando-o por pi
+	if (vx < 0) {
+		vx = -vx;
+		vy = -vy;
+		z = y >= 0 ? CORDIC_PI : -CORDIC_PI;
+	}
+
+	// Amplia o vetor para que os deslocamentos das ltimas iteraes no percam bits
+	while ((vx > vy ? vx : vy) < CORDIC_TOP && (vx > -vy ? vx : -vy) < CORDIC_TOP) {
+		vx *= 2;
+		vy *= 2;
+	}
+
+	// Gira o vetor at o eixo x, acumulando o ngulo percorrido
+	for (int i = 0; i < CORDIC_STEPS; i++) {
+		int64_t dx = vy >> i;
+		int64_t dy = vx >> i;
+
+		if (vy > 0) {
+			vx += dx;
+			vy -= dy;
+			z += atan_table[i];
+		}
+		else {
+			vx -= dx;
+			vy += dy;
+			z -= atan_table[i];
+		}
+	}
+	return (fixed_t)fx_round_shift(z, CORDIC_SHIFT - FX_SHIFT);
+}
@@ -0,0 +1,57 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+
+// Aritmtica de ponto fixo Q16.16: 16 bits de parte inteira (com sinal) e 16 de frao, o que
+// cobre 32768 com resoluo de 1/65536. Todas as operaes usam s inteiros, ento o resultado
+//  o mesmo bit a bit em qualquer processador e com qualquer compilador. Os produtos e quocientes
+// passam por 64 bits e so arredondados para o mais prximo.
+
+typedef int32_t fixed_t;
+
+#define FX_SHIFT 16 // Bits de frao
+#define FX_ONE ((fixed_t)1 << FX_SHIFT) // Valor 1
+
+// Os arredondamentos dependem do deslocamento  direita de negativos ser aritmtico
+_Static_assert((-1 >> 1) == -1, "o deslocamento  direita de inteiros negativos precisa ser aritmtico");
+
+// Desloca v s bits para a direita, arredondando para o mais prximo
+static inline int64_t fx_round_shift(int64_t v, int s) {
+	return (v + ((int64_t)1 << (s - 1))) >> s;
+}
+
+// Multiplica dois valores
+static inline fixed_t fx_mul(fixed_t a, fixed_t b) {
+	return (fixed_t)fx_round_shift((int64_t)a * b, FX_SHIFT);
+}
+
+// Divide a por b (diferente de 0), truncando em direo a zero
+static inline fixed_t fx_div(fixed_t a, fixed_t b) {
+	return (fixed_t)((int64_t)a * FX_ONE / b);
+}
+
+// Converte para double, sem perda
+static inline double fx_to_double(fixed_t a) {
+	return a / (double)FX_ONE;
+}
+
+// Converte de double, arredondando para o mais prximo e saturando fora da faixa (NaN vira 0)
+fixed_t fx_from_double(double v);
+
+// Raiz quadrada inteira (a maior r com r <= v)
+uint64_t fx_isqrt64(uint64_t v);
+
+// Raiz quadrada de a >= 0 (negativos do 0)
+fixed_t fx_sqrt(fixed_t a);
+
+// Calcula o seno e o cosseno de um ngulo em radianos (CORDIC)
+void fx_sincos(fixed_t radians, fixed_t* s, fixed_t* c);
+
+// Calcula o seno e o cosseno de um ngulo em graus (a reduo de faixa  feita em graus, sem erro)
+void fx_sincos_deg(fixed_t degrees, fixed_t* s, fixed_t* c);
+
+// Calcula o ngulo de (x, y) em radianos, em [-pi, pi] (CORDIC)
+fixed_t fx_atan2(fixed_t y, fixed_t x);
+
+#endif
@@ -0,0 +1,147 @@
+#include "grid.h"
+
+// Funo que inicializa a grade vazia
+void grid_init(struct Grid* g, int cols, int rows, float cell_size, int capacity, void* buffer) {
+	int n = ENTITY_ROUND_CAPACITY(capacity);
+	int* p = (int*)buffer;
+
+	g->cols = cols;
+	g->rows = rows;
+	g->cell_size = real_from_float(cell_size);
+	g->capacity = n;
+	g->head = p;
+	g->next = p + cols * rows;
+	g->prev = g->next + n;
+	g->cell = g->prev + n;
+	g->member = (uint32_t*)(g->cell + n);
+
+	for (int c = 0; c < cols * rows; c++) {
+		g->head[c] = -1;
+	}
+
+	for (int i = 0; i < n; i++) {
+		g->cell[i] = -1;
+	}
+
+	for (int w = 0; w < n / ENTITY_MASK_BITS; w++) {
+		g->member[w] = 0;
+	}
+}
+
+// Funo que retira a entidade i da lista da sua clula
+static void unlink(struct Grid* g, int i) {
+	if (g->prev[i] >= 0) {
+		g->next[g->prev[i]] = g->next[i];
+	}
+	else {
+		g->head[g->cell[i]] = g->next[i];
+	}
+
+	if (g->next[i] >= 0) {
+		g->prev[g->next[i]] = g->prev[i];
+	}
+}
+
+void grid_move(struct Grid* g, int i, real_t x, real_t y) {
+	int cx, cy, c;
+
+	grid_coords(g, x, y, &cx, &cy);
+	c = cy * g->cols + cx;
+
+	// No faz nada se a entidade continua na mesma clula
+	if (g->cell[i] == c) {
+		return;
+	}
+
+	if (g->cell[i] >= 0) {
+		unlink(g, i);
+	}
+
+	// Insere a entidade no incio da lista da nova clula
+	g->cell[i] = c;
+	g->prev[i] = -1;
+	g->next[i] = g->head[c];
+	if (g->head[c] >= 0) {
+		g->prev[g->head[c]] = i;
+	}
+	g->head[c] = i;
+
+	g->member[i / ENTITY_MASK_BITS] |= (uint32_t)1 << (i % ENTITY_MASK_BITS);
+}
+
+void grid_remove(struct Grid* g, int i) {
+	if (g->cell[i] < 0) {
+		return;
+	}
+
+	unlink(g, i);
+	g->cell[i] = -1;
+
+	g->member[i / ENTITY_MASK_BITS] &= ~((uint32_t)1 << (i % ENTITY_MASK_BITS));
+}
+
+// Funo que sincroniza a grade, visitando s as entidades ativas ou que ainda esto na grade
+void grid_sync(struct Grid* g, const struct EntityStore* s) {
+	int words = s->capacity / ENTITY_MASK_BITS;
+
+	for (int w = 0; w < words; w++) {
+		uint32_t bits = s->active[w] | g->member[w];
+
+		while (bits) {
+			int i = w * ENTITY_MASK_BITS + entities_ctz(bits);
+			bits &= bits - 1;
+
+			if (entities_is_active(s, i)) {
+				// A entidade continua ativa: acompanha a sua posio
+				grid_move(g, i, s->x[i], s->y[i]);
+			}
+			else {
+				// A entidade foi desativada: sai da grade
+				grid_remove(g, i);
+			}
+		}
+	}
+}
+
+void grid_changed(const struct Grid* g, const struct EntityStore* s, int first, int last, uint32_t* changed) {
+	for (int w = first; w < last; w++) {
+		uint32_t bits = s->active[w] | g->member[w];
+		uint32_t mask = 0;
+
+		while (bits) {
+			int j = entities_ctz(bits);
+			int i = w * ENTITY_MASK_BITS + j;
+			int cx, cy;
+
+			bits &= bits - 1;
+			if (entities_is_active(s, i)) {
+				grid_coords(g, s->x[i], s->y[i], &cx, &cy);
+				if (g->cell[i] == cy * g->cols + cx) {
+					continue;
+				}
+			}
+			mask |= (uint32_t)1 << j;
+		}
+		changed[w] = mask;
+	}
+}
+
+void grid_apply(struct Grid* g, const struct EntityStore* s, const uint32_t* changed) {
+	int words = s->capacity / ENTITY_MASK_BITS;
+
+	for (int w = 0; w < words; w++) {
+		uint32_t bits = changed[w];
+
+		while (bits) {
+			int i = w * ENTITY_MASK_BITS + entities_ctz(bits);
+			bits &= bits - 1;
+
+			if (entities_is_active(s, i)) {
+				grid_move(g, i, s->x[i], s->y[i]);
+			}
+			else {
+				grid_remove(g, i);
+			}
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+
+#include "entities.h"
+
+// Nmero de bytes necessrios para uma grade de cols x rows clulas com capacity entidades
+#define GRID_BYTES(cols, rows, capacity) (((cols) * (rows) + 3 * ENTITY_ROUND_CAPACITY(capacity)) * sizeof(int) + ENTITY_ROUND_CAPACITY(capacity) / 8)
+
+// Grade uniforme sobre a janela grfica, usada como fase ampla da deteco de colises.
+// Cada clula guarda uma lista duplamente encadeada das entidades que esto nela,
+// e a grade  atualizada de forma incremental: s muda de lista quem trocou de clula.
+struct Grid {
+	int cols; // Nmero de colunas
+	int rows; // Nmero de linhas
+	real_t cell_size; // Tamanho do lado de cada clula
+	int capacity; // Nmero mximo de entidades
+	int* head; // Primeira entidade de cada clula (-1 se vazia)
+	int* next; // Prxima entidade na mesma clula
+	int* prev; // Entidade anterior na mesma clula
+	int* cell; // Clula atual de cada entidade (-1 se fora da grade)
+	uint32_t* member; // Mscara de bits das entidades que esto na grade
+};
+
+// Inicializa a grade sobre um buffer de GRID_BYTES(cols, rows, capacity) bytes
+void grid_init(struct Grid* g, int cols, int rows, float cell_size, int capacity, void* buffer);
+
+// Coloca a entidade i na clula da posio (x, y), movendo-a se j estava em outra clula
+void grid_move(struct Grid* g, int i, real_t x, real_t y);
+
+// Retira a entidade i da grade
+void grid_remove(struct Grid* g, int i);
+
+// Sincroniza a grade com as posies e a mscara de ativos de um armazenamento de entidades
+void grid_sync(struct Grid* g, const struct EntityStore* s);
+
+// Primeira metade de grid_sync, s de leitura: marca em changed[first..last) as entidades das
+// palavras [first, last) que trocaram de clula ou que ainda esto na grade mas foram desativadas
+void grid_changed(const struct Grid* g, const struct EntityStore* s, int first, int last, uint32_t* changed);
+
+// Segunda metade de grid_sync: move ou retira as entidades marcadas em changed, em ordem de ndice
+void grid_apply(struct Grid* g, const struct EntityStore* s, const uint32_t* changed);
+
+// Calcula a coluna e a linha da clula que contm a posio (x, y). Em ponto fixo o quociente de
+// dois Q16.16 j  o ndice da clula.
+static inline void grid_coords(const struct Grid* g, real_t x, real_t y, int* cx, int* cy) {
+	int c = (int)(x / g->cell_size);
+	int r = (int)(y / g->cell_size);
+
+	*cx = c < 0 ? 0 : (c >= g->cols ? g->cols - 1 : c);
+	*cy = r < 0 ? 0 : (r >= g->rows ? g->rows - 1 : r);
+}
+
+#endif
@@ -0,0 +1,372 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // syscall, para o perf_event_open
+#elif !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+
+#include "host.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+
+// Ponto de entrada das threads no Windows
+static DWORD WINAPI thread_entry(LPVOID p) {
+	struct HostThread* t = (struct HostThread*)p;
+	t->fn(t->arg);
+	return 0;
+}
+
+int host_thread_start(struct HostThread* t, host_thread_fn fn, void* arg) {
+	t->fn = fn;
+	t->arg = arg;
+	t->handle = CreateThread(NULL, 0, thread_entry, t, 0, NULL);
+	return t->handle != NULL ? 0 : -1;
+}
+
+void host_thread_join(struct HostThread* t) {
+	WaitForSingleObject(t->handle, INFINITE);
+	CloseHandle(t->handle);
+}
+
+static void lock_init(host_lock* l, host_cond* c) {
+	InitializeSRWLock(l);
+	InitializeConditionVariable(c);
+}
+
+static void lock_acquire(host_lock* l) {
+	AcquireSRWLockExclusive(l);
+}
+
+static void lock_release(host_lock* l) {
+	ReleaseSRWLockExclusive(l);
+}
+
+static void cond_wait(host_cond* c, host_lock* l) {
+	SleepConditionVariableSRW(c, l, INFINITE, 0);
+}
+
+static void cond_broadcast(host_cond* c) {
+	WakeAllConditionVariable(c);
+}
+
+static void lock_destroy(host_lock* l, host_cond* c) {
+	// As travas do Windows no precisam ser destrudas
+	(void)l;
+	(void)c;
+}
+
+int host_cpu_count(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+}
+
+void* host_aligned_alloc(size_t align, size_t size) {
+	return _aligned_malloc(size, align);
+}
+
+void host_aligned_free(void* p) {
+	_aligned_free(p);
+}
+
+uint64_t host_time_ns(void) {
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER now;
+
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&now);
+
+	// Separa segundos e resto para no estourar 64 bits na multiplicao
+	return (uint64_t)(now.QuadPart / frequency.QuadPart) * 1000000000u
+		+ (uint64_t)(now.QuadPart % frequency.QuadPart) * 1000000000u / (uint64_t)frequency.QuadPart;
+}
+
+int host_cache_counter_open(void) {
+	return -1;
+}
+
+void host_counter_start(int counter) {
+	(void)counter;
+}
+
+uint64_t host_counter_stop(int counter) {
+	(void)counter;
+	return 0;
+}
+
+void host_counter_close(int counter) {
+	(void)counter;
+}
+
+int host_map_file(struct HostMapping* m, const char* path) {
+	LARGE_INTEGER size;
+
+	m->data = NULL;
+	m->mapping = NULL;
+	m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m->file, &size) || size.QuadPart == 0) {
+		host_unmap_file(m);
+		return -1;
+	}
+	m->size = (size_t)size.QuadPart;
+
+	m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m->mapping != NULL) {
+		m->data = (const uint8_t*)MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (m->data == NULL) {
+		host_unmap_file(m);
+		return -1;
+	}
+	return 0;
+}
+
+void host_unmap_file(struct HostMapping* m) {
+	if (m->data != NULL) {
+		UnmapViewOfFile(m->data);
+	}
+	if (m->mapping != NULL) {
+		CloseHandle(m->mapping);
+	}
+	if (m->file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m->file);
+	}
+	m->data = NULL;
+	m->mapping = NULL;
+	m->file = INVALID_HANDLE_VALUE;
+}
+#else
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+// Ponto de entrada das threads POSIX
+static void* thread_entry(void* p) {
+	struct HostThread* t = (struct HostThread*)p;
+	t->fn(t->arg);
+	return NULL;
+}
+
+int host_thread_start(struct HostThread* t, host_thread_fn fn, void* arg) {
+	t->fn = fn;
+	t->arg = arg;
+	return pthread_create(&t->handle, NULL, thread_entry, t) == 0 ? 0 : -1;
+}
+
+void host_thread_join(struct HostThread* t) {
+	pthread_join(t->handle, NULL);
+}
+
+static void lock_init(host_lock* l, host_cond* c) {
+	pthread_mutex_init(l, NULL);
+	pthread_cond_init(c, NULL);
+}
+
+static void lock_acquire(host_lock* l) {
+	pthread_mutex_lock(l);
+}
+
+static void lock_release(host_lock* l) {
+	pthread_mutex_unlock(l);
+}
+
+static void cond_wait(host_cond* c, host_lock* l) {
+	pthread_cond_wait(c, l);
+}
+
+static void cond_broadcast(host_cond* c) {
+	pthread_cond_broadcast(c);
+}
+
+static void lock_destroy(host_lock* l, host_cond* c) {
+	pthread_cond_destroy(c);
+	pthread_mutex_destroy(l);
+}
+
+int host_cpu_count(void) {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int)n : 1;
+}
+
+void* host_aligned_alloc(size_t align, size_t size) {
+	void* p = NULL;
+	return posix_memalign(&p, align, size) == 0 ? p : NULL;
+}
+
+void host_aligned_free(void* p) {
+	free(p);
+}
+
+uint64_t host_time_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+int host_map_file(struct HostMapping* m, const char* path) {
+	struct stat st;
+	void* p;
+	int fd = open(path, O_RDONLY);
+
+	m->data = NULL;
+	m->size = 0;
+	if (fd < 0) {
+		return -1;
+	}
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return -1;
+	}
+
+	// O mapeamento continua vlido depois que o descritor  fechado
+	p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) {
+		return -1;
+	}
+	m->data = (const uint8_t*)p;
+	m->size = (size_t)st.st_size;
+	return 0;
+}
+
+void host_unmap_file(struct HostMapping* m) {
+	if (m->data != NULL) {
+		munmap((void*)m->data, m->size);
+	}
+	m->data = NULL;
+	m->size = 0;
+}
+
+#if defined(__linux__)
+int host_cache_counter_open(void) {
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+void host_counter_start(int counter) {
+	if (counter >= 0) {
+		ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+uint64_t host_counter_stop(int counter) {
+	uint64_t count = 0;
+
+	if (counter >= 0) {
+		ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(counter, &count, sizeof(count)) != sizeof(count)) {
+			count = 0;
+		}
+	}
+	return count;
+}
+
+void host_counter_close(int counter) {
+	if (counter >= 0) {
+		close(counter);
+	}
+}
+#else
+int host_cache_counter_open(void) {
+	return -1;
+}
+
+void host_counter_start(int counter) {
+	(void)counter;
+}
+
+uint64_t host_counter_stop(int counter) {
+	(void)counter;
+	return 0;
+}
+
+void host_counter_close(int counter) {
+	(void)counter;
+}
+#endif
+#endif
+
+// A barreira usa s as travas acima, ento  a mesma nos dois sistemas
+int host_barrier_init(struct HostBarrier* b, int count) {
+	if (count <= 0) {
+		return -1;
+	}
+
+	b->count = count;
+	b->waiting = 0;
+	atomic_init(&b->round, 0);
+	lock_init(&b->lock, &b->cond);
+	return 0;
+}
+
+// Funo que abre a rodada seguinte e acorda quem dormiu (com a trava)
+static void open_round(struct HostBarrier* b, unsigned int round) {
+	b->waiting = 0;
+	atomic_store_explicit(&b->round, round + 1, memory_order_release);
+	cond_broadcast(&b->cond);
+}
+
+void host_barrier_wait(struct HostBarrier* b) {
+	unsigned int round;
+
+	lock_acquire(&b->lock);
+	round = atomic_load_explicit(&b->round, memory_order_relaxed);
+	if (++b->waiting == b->count) {
+		// ltima a chegar
+		open_round(b, round);
+		lock_release(&b->lock);
+		return;
+	}
+	lock_release(&b->lock);
+
+	// Espera ativa curta, sem a trava
+	for (int k = 0; k < HOST_BARRIER_SPIN; k++) {
+		if (atomic_load_explicit(&b->round, memory_order_acquire) != round) {
+			return;
+		}
+	}
+
+	// Dorme; a rodada s muda com a trava, ento o aviso no se perde
+	lock_acquire(&b->lock);
+	while (atomic_load_explicit(&b->round, memory_order_acquire) == round) {
+		cond_wait(&b->cond, &b->lock);
+	}
+	lock_release(&b->lock);
+}
+
+void host_barrier_drop(struct HostBarrier* b) {
+	lock_acquire(&b->lock);
+	b->count--;
+	if (b->waiting > 0 && b->waiting == b->count) {
+		open_round(b, atomic_load_explicit(&b->round, memory_order_relaxed));
+	}
+	lock_release(&b->lock);
+}
+
+void host_barrier_destroy(struct HostBarrier* b) {
+	lock_destroy(&b->lock, &b->cond);
+}
@@ -0,0 +1,103 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Camada mnima de portabilidade para o que roda fora do escalonador do FreeRTOS
+// (modo em lote, passo paralelo e ferramentas): threads do sistema, barreira, nmero de ncleos,
+// memria alinhada, relgio e arquivos mapeados em memria.
+
+typedef void (*host_thread_fn)(void* arg);
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef HANDLE host_thread_handle;
+typedef SRWLOCK host_lock;
+typedef CONDITION_VARIABLE host_cond;
+#else
+#include <pthread.h>
+typedef pthread_t host_thread_handle;
+typedef pthread_mutex_t host_lock;
+typedef pthread_cond_t host_cond;
+#endif
+
+// Nmero de tentativas de uma thread na barreira antes de dormir
+#define HOST_BARRIER_SPIN 20000
+
+// Thread do sistema hospedeiro
+struct HostThread {
+	host_thread_handle handle; // Identificador da thread no sistema
+	host_thread_fn fn; // Funo executada pela thread
+	void* arg; // Argumento passado para a funo
+};
+
+// Cria uma thread que executa fn(arg). Retorna 0 em caso de sucesso.
+int host_thread_start(struct HostThread* t, host_thread_fn fn, void* arg);
+
+// Aguarda o fim de uma thread
+void host_thread_join(struct HostThread* t);
+
+// Barreira reutilizvel para um nmero fixo de threads. Quem chega espera um pouco ativamente,
+// porque entre as fases de um passo a espera  curta, e depois dorme at a ltima chegar.
+struct HostBarrier {
+	int count; // Nmero de threads que participam
+	int waiting; // Threads que j chegaram na rodada atual (protegido por lock)
+	atomic_uint round; // Nmero da rodada, incrementado pela ltima thread a chegar
+	host_lock lock; // Trava de waiting e da espera em cond
+	host_cond cond; // Acorda as threads que dormiram
+};
+
+// Inicializa uma barreira para count threads. Retorna 0 em caso de sucesso.
+int host_barrier_init(struct HostBarrier* b, int count);
+
+// Espera at que as count threads cheguem na barreira. Tudo o que uma thread escreveu antes de
+// chegar fica visvel para as outras depois que elas saem.
+void host_barrier_wait(struct HostBarrier* b);
+
+// Retira uma thread da barreira sem esperar: as rodadas seguintes (e a atual, se s faltava ela)
+// esperam uma thread a menos
+void host_barrier_drop(struct HostBarrier* b);
+
+void host_barrier_destroy(struct HostBarrier* b);
+
+// Retorna o nmero de ncleos lgicos disponveis
+int host_cpu_count(void);
+
+// Aloca e libera memria alinhada em align bytes
+void* host_aligned_alloc(size_t align, size_t size);
+void host_aligned_free(void* p);
+
+// Retorna o tempo de um relgio monotnico de alta resoluo em nanossegundos
+uint64_t host_time_ns(void);
+
+// Abre um contador de falhas de cache da thread atual (perf_event_open no Linux).
+// Retorna -1 se o contador no est disponvel.
+int host_cache_counter_open(void);
+
+// Zera e liga o contador
+void host_counter_start(int counter);
+
+// Desliga o contador e retorna o valor contado desde host_counter_start
+uint64_t host_counter_stop(int counter);
+
+void host_counter_close(int counter);
+
+// Arquivo mapeado em memria, s para leitura
+struct HostMapping {
+	const uint8_t* data; // Contedo do arquivo
+	size_t size; // Tamanho do arquivo em bytes
+#if defined(_WIN32)
+	HANDLE file; // Arquivo aberto
+	HANDLE mapping; // Objeto de mapeamento
+#endif
+};
+
+// Mapeia um arquivo inteiro para leitura. Retorna 0 em caso de sucesso.
+int host_map_file(struct HostMapping* m, const char* path);
+
+// Desfaz o mapeamento
+void host_unmap_file(struct HostMapping* m);
+
+#endif
@@ -50,14 +50,29 @@
  */
 
 /* Standard includes. */
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 //#include <conio.h>
 
 /* FreeRTOS kernel includes. */
 #include "FreeRTOS.h"
 #include "task.h"
-#include <queue.h>
+
+/* Simulation includes. */
+#include "simulation.h"
+#include "assign.h"
+#include "batch.h"
+#include "ring.h"
+#include "recorder.h"
+#include "replay.h"
+#include "stats.h"
+#include "rtmon.h"
+#include "snapshot.h"
+#include "render.h"
+#include "host.h"
+#include "tick.h"
 
 /* This project provides two demo applications.  A simple blinky style demo
 application, and a more comprehensive test and demo application.  The
@@ -80,6 +95,29 @@ choice.  See http://www.freertos.org/a00111.html for an explanation. */
 #define mainREGION_2_SIZE	29905
 #define mainREGION_3_SIZE	6407
 
+/* Prioridades das tarefas.  Compilando com mainUSE_TASK_CONFIG elas vm do
+task_config.h gerado por tools/schedcheck.c a partir dos tempos gravados com
+--rt-log. */
+#ifdef mainUSE_TASK_CONFIG
+	#include "task_config.h"
+#endif
+#ifndef TASK_ATTACK_PRIORITY
+	#define TASK_ATTACK_PRIORITY	1
+#endif
+#ifndef TASK_DEFENSE_PRIORITY
+	#define TASK_DEFENSE_PRIORITY	1
+#endif
+#ifndef TASK_MONITOR_PRIORITY
+	#define TASK_MONITOR_PRIORITY	1
+#endif
+
+/* Tamanho da arena esttica de onde saem as entidades, as reas, os anis, a
+onda de ataque e o acmulo de ameaas da defesa.  Comporta tanto a demonstrao
+padro quanto o cenrio --stress com 10^5 msseis. */
+#ifndef mainARENA_SIZE
+	#define mainARENA_SIZE	( 48 * 1024 * 1024 )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -105,6 +143,12 @@ choice.  See http://www.freertos.org/a00111.html for an explanation. */
  */
 static void  prvInitialiseHeap( void );
 
+/*
+ * Reserva na arena esttica toda a memria da simulao para a configurao
+ * escolhida na inicializao.  Nada mais  alocado depois disso.
+ */
+static int prvInitialiseArena( const struct SimConfig *pxConfig );
+
 /*
  * Prototypes for the standard FreeRTOS application hook (callback) functions
  * implemented within this file.  See http://www.freertos.org/a00016.html .
@@ -138,64 +182,91 @@ static BaseType_t xTraceRunning = pdTRUE;
 
 
 // Define algumas constantes para o sistema
-#define NUM_MISSILES 10 // Nmero mximo de msseis por ataque
-#define NUM_INTERCEPTORS 5 // Nmero mximo de interceptores por defesa
-#define ATTACK_INTERVAL 5000 // Intervalo entre ataques em milissegundos
-#define DEFENSE_INTERVAL 1000 // Intervalo entre defesas em milissegundos
-#define WINDOW_WIDTH 800 // Largura da janela grfica
-#define WINDOW_HEIGHT 600 // Altura da janela grfica
-#define GRAVITY 9.8 // Acelerao da gravidade
-#define PI 3.14159 // Valor de pi
-
-// Define algumas estruturas de dados para o sistema
-struct Missile {
-	float x; // Posio x do mssil
-	float y; // Posio y do mssil
-	float vx; // Velocidade x do mssil
-	float vy; // Velocidade y do mssil
-	float angle; // ngulo de lanamento do mssil
-	float speed; // Velocidade de lanamento do mssil
-	int active; // Indica se o mssil est ativo ou no
-	int targeted; // Indica se o mssil est direcionado a uma rea habitada ou no
-};
-
-struct Area {
-	float x; // Posio x da rea
-	float y; // Posio y da rea
-	float width; // Largura da rea
-	float height; // Altura da rea
-	int hit; // Indica se a rea foi atingida por um mssil ou no
-};
-
-struct Missile missiles[NUM_MISSILES]; // Vetor de msseis
-struct Missile interceptors[NUM_INTERCEPTORS]; // Vetor de interceptores
-struct Area areas[3]; // Vetor de reas habitadas
-int num_missiles; // Nmero de msseis disparados pelo ataque
-int num_interceptors; // Nmero de interceptores disparados pela defesa
-int num_hits; // Nmero de msseis que atingiram as reas
-int num_intercepts; // Nmero de msseis que foram interceptados
-QueueHandle_t attack_queue; // Fila de comunicao entre o ataque e a defesa
+#define BATCH_DEFAULT_SCENARIOS 1000 // Nmero padro de cenrios no modo em lote
+#define BATCH_DEFAULT_DURATION 300.0f // Tempo simulado padro de cada cenrio em segundos
+#define WRITER_PERIOD_MS 100 // Perodo da tarefa de gravao em milissegundos
+#define REPORT_PERIOD_MS 10000 // Perodo da tarefa de relatrio em milissegundos
+#define RENDER_PERIOD_MS 500 // Perodo padro da tarefa de desenho em milissegundos
+#define RENDER_PATH_LENGTH 260 // Tamanho mximo do nome de um arquivo PPM
+
+// Converte milissegundos em nanossegundos (para a instrumentao de tempo real)
+#define MS_TO_NS(ms) ((uint64_t)(ms) * 1000000u)
+
+// Converte uma contagem de ticks do FreeRTOS em segundos
+#define TICKS_TO_SECONDS(t) ((double)(t) * portTICK_PERIOD_MS / 1000.0)
+
+// Converte um intervalo em segundos na menor contagem de ticks que o cobre
+#define SECONDS_TO_TICKS(s) ((TickType_t)ceil((s) * 1000.0 / portTICK_PERIOD_MS))
+
+// Converte um intervalo de tempo simulado em nanossegundos (intervalos negativos viram 0)
+#define SECONDS_TO_NS(s) ((s) > 0 ? (uint64_t)((s) * 1e9) : 0)
+
+static struct Simulation sim; // Estado da simulao (os vetores de entidades s so alterados pelo monitor)
+
+static struct Arena arena; // Arena com a memria da simulao, dos anis e da onda de ataque
+static struct LaunchDescriptor* attack_buffer; // Descritores da onda de ataque (config.missiles_per_wave)
+static struct LaunchDescriptor* defense_buffer; // Interceptores de uma ativao da defesa (config.interceptors_per_defense)
+static struct Assignment assignment; // Ameaas ainda sem resposta e atribuio dos interceptores, s da defesa
+static TaskHandle_t defense_task; // Tarefa de defesa, notificada pelo ataque a cada onda
+
+struct SpscRing launch_ring; // Msseis lanados, do ataque para o monitor
+struct SpscRing threat_ring; // Ameaas, do ataque para a defesa
+struct SpscRing intercept_ring; // Interceptores lanados, da defesa para o monitor
+
+static struct Histogram update_time; // Durao de cada update(), escrito pelo monitor
+static struct Histogram queue_wait; // Espera das ameaas no anel at a defesa, escrito pela defesa
+static struct Histogram reaction_time; // Tempo do lanamento do mssil ao do interceptor, escrito pelo monitor
+
+static struct RtTask rt_attack; // Jobs, prazos e WCET da tarefa de ataque
+static struct RtTask rt_defense; // Jobs, prazos e WCET da tarefa de defesa
+static struct RtTask rt_monitor; // Jobs, prazos e WCET da tarefa de monitor
+
+static struct Snapshot snapshot; // Estado publicado pelo monitor a cada passo para a tarefa de desenho
+static struct SnapshotFrame render_frame; // Cpia do ltimo quadro publicado, da tarefa de desenho
+static int render_period_ms = RENDER_PERIOD_MS; // Perodo da tarefa de desenho (--render-period), ou 0 para no desenhar
+static const char* ppm_prefix; // Prefixo dos arquivos PPM (--ppm), ou NULL para desenhar em ASCII
+static uint8_t* ppm_pixels; // Imagem de trabalho dos quadros PPM
+
+static struct Recorder recorder; // Gravador do estado da simulao a cada passo
+static const char* record_path; // Arquivo da gravao (--record), ou NULL para no gravar
+static const char* rt_log_path; // Conjunto de tarefas para tools/schedcheck.c (--rt-log), ou NULL
+static struct Area* area_file; // reas lidas de --areas-file, ou NULL para sorte-las
+static int tick_threads = 1; // Threads que dividem cada passo do monitor (--tick-threads)
+static struct TickPool tick_pool; // Threads de trabalho do passo paralelo, usadas s pelo monitor
 
 // Declara as funes do sistema
-void init(); // Inicializa o sistema
 void attack(void *pvParameters); // Funo da tarefa de ataque
 void defense(void *pvParameters); // Funo da tarefa de defesa
 void monitor(void *pvParameters); // Funo da tarefa de monitor
+void writer(void *pvParameters); // Funo da tarefa de gravao
+void report(void *pvParameters); // Funo da tarefa de relatrio
+void render(void *pvParameters); // Funo da tarefa de desenho
+int parse_config(int argc, char **argv, struct SimConfig *config); // L e retira de argv as opes de configurao
+int run_batch(int argc, char **argv, const struct SimConfig *config); // Executa o modo em lote, sem o escalonador
+int run_replay(int argc, char **argv); // Reproduz uma gravao, sem o escalonador
+void ring_send(struct SpscRing *r, const struct LaunchDescriptor *d); // Envia um descritor, esperando se o anel estiver cheio
+
+int main( int argc, char **argv )
+{
+	struct SimConfig config;
 
-void update(); // Atualiza o estado do sistema
-void launch_missile(struct Missile *m, float x, float y, float angle, float speed); // Lana um mssil com os parmetros dados
-void launch_interceptor(struct Missile *m, float x, float y, float angle, float speed); // Lana um interceptor com os parmetros dados
-int is_in_area(struct Missile *m, struct Area *a); // Verifica se um mssil est dentro de uma rea
-int is_intercepted(struct Missile *m1, struct Missile *m2); // Verifica se um mssil foi interceptado por outro
-float random(float min, float max); // Gera um nmero aleatrio entre min e max
-float to_radians(float degrees); // Converte graus em radianos
-float to_degrees(float radians); // Converte radianos em graus
+	// L a configurao da linha de comando (capacidades, anis e janela)
+	sim_default_config(&config);
+	argc = parse_config(argc, argv, &config);
+	if (argc < 0) {
+		return 1;
+	}
 
-float calculate_angle(struct Missile* m);
-float calculate_speed(struct Missile* m);
+	// Com "--batch" executa os cenrios em lote e sai sem iniciar o escalonador
+	if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+		return run_batch(argc - 2, argv + 2, &config);
+	}
+
+	// Com "--replay" reproduz uma gravao e sai sem iniciar o escalonador
+	if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+		return run_replay(argc - 2, argv + 2);
+	}
 
-int main( void )
-{
 	/* This demo uses heap_5.c, so start by defining some heap regions.  heap_5
 	is only used for test and example reasons.  Heap_4 is more appropriate.  See
 	http://www.freertos.org/a00111.html for an explanation. */
@@ -205,13 +276,34 @@ int main( void )
 	See http://www.FreeRTOS.org/trace for more information. */
 	vTraceEnable( TRC_START );
 
+	// Reserva a memria da simulao e dos anis de comunicao entre o ataque, a defesa e o monitor
+	if (prvInitialiseArena(&config) != 0) {
+		printf("Configurao invlida ou maior do que a arena de %lu bytes\r\n", (unsigned long)mainARENA_SIZE);
+		return 1;
+	}
+
 	// Inicializa o sistema
-	init();
+	init(&sim);
+
+	// Prazos implcitos: cada job deve terminar antes da prxima liberao (no ataque, antes do
+	// maior intervalo entre ondas)
+	rtmon_init(&rt_attack, "Attack", MS_TO_NS(ATTACK_INTERVAL), MS_TO_NS(ATTACK_INTERVAL), RTMON_DELAYED);
+	rtmon_init(&rt_defense, "Defense", MS_TO_NS(DEFENSE_INTERVAL), MS_TO_NS(DEFENSE_INTERVAL), RTMON_SPORADIC);
+	rtmon_init(&rt_monitor, "Monitor", MS_TO_NS(MONITOR_PERIOD_MS), MS_TO_NS(MONITOR_PERIOD_MS), RTMON_PERIODIC);
 
 	// Cria as tarefas do FreeRTOS
-	xTaskCreate(attack, "Attack", 1000, NULL, 1, NULL);
-	xTaskCreate(defense, "Defense", 1000, NULL, 1, NULL);
-	xTaskCreate(monitor, "Monitor", 1000, NULL, 1, NULL);
+	xTaskCreate(attack, "Attack", 1000, NULL, TASK_ATTACK_PRIORITY, NULL);
+	xTaskCreate(defense, "Defense", 1000, NULL, TASK_DEFENSE_PRIORITY, &defense_task);
+	xTaskCreate(monitor, "Monitor", 1000, NULL, TASK_MONITOR_PRIORITY, NULL);
+	xTaskCreate(report, "Report", 1000, NULL, tskIDLE_PRIORITY, NULL);
+	if (render_period_ms > 0) {
+		// O desenho s l os quadros publicados, ento pode ficar na prioridade mnima
+		xTaskCreate(render, "Render", 1000, NULL, tskIDLE_PRIORITY, NULL);
+	}
+	if (record_path != NULL) {
+		// A gravao em disco fica abaixo das outras tarefas, s com o tempo que sobrar
+		xTaskCreate(writer, "Writer", 1000, NULL, tskIDLE_PRIORITY, NULL);
+	}
 
 	// Inicia o escalonador do FreeRTOS
 	vTaskStartScheduler();
@@ -219,311 +311,454 @@ int main( void )
 	return 0;
 }
 
-// Funo que inicializa o sistema
-void init() {
-	// Inicializa as variveis globais
-	num_missiles = 0;
-	num_interceptors = 0;
-	num_hits = 0;
-	num_intercepts = 0;
-
-	// Inicializa os msseis e os interceptores como inativos
-	for (int i = 0; i < NUM_MISSILES; i++) {
-		missiles[i].active = 0;
-	}
-
-	for (int i = 0; i < NUM_INTERCEPTORS; i++) {
-		interceptors[i].active = 0;
-	}
-
-	// Inicializa as reas habitadas com posies e tamanhos aleatrios
-	for (int i = 0; i < 3; i++) {
-		areas[i].x = random(100, 200);
-		areas[i].y = random(100, 200);
-		areas[i].width = random(10, 50);
-		areas[i].height = random(10, 50);
-		areas[i].hit = 0;
-	}
+ /* ----------Minhas definies de funes-------------------*/
 
-	// Cria a fila de comunicao entre o ataque e a defesa
-	attack_queue = xQueueCreate(10, sizeof(int));
+// Funo que associa a instrumentao de tempo real  tarefa atual, para os ganchos de trace
+static void rt_register(struct RtTask* t) {
+#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+	vTaskSetApplicationTaskTag(NULL, (TaskHookFunction_t)t);
+#else
+	(void)t;
+#endif
 }
 
-
- /* ----------Minhas definies de funes-------------------*/
-
 // Funo da tarefa de ataque
 void attack(void* pvParameters) {
-	// Declara uma varivel para armazenar o nmero de msseis a serem disparados
+	// Declara uma varivel para armazenar o nmero de msseis a serem disparados e os seus descritores
 	int n;
+	TickType_t delay;
+	struct LaunchDescriptor* wave = attack_buffer;
+
+	rt_register(&rt_attack);
 
 	// Entra em um loop infinito
 	while (1) {
-		// Gera um nmero aleatrio de msseis a serem disparados entre 1 e NUM_MISSILES
-		n = random(1, NUM_MISSILES);
+		rtmon_job_start(&rt_attack);
 
-		// Envia o nmero de msseis para a fila de comunicao
-		xQueueSend(attack_queue, &n, portMAX_DELAY);
+		// Gera um nmero aleatrio de msseis
+		n = attack_wave(&sim, TICKS_TO_SECONDS(xTaskGetTickCount()), wave);
 
-		// Lana os msseis com parmetros aleatrios
+		// Envia os descritores para o monitor, que lana os msseis, e para a defesa
 		for (int i = 0; i < n; i++) {
-			launch_missile(&missiles[i], 0, WINDOW_HEIGHT, random(10, 80), random(100, 200));
+			ring_send(&launch_ring, &wave[i]);
+			ring_send(&threat_ring, &wave[i]);
 		}
 
-		// Atualiza o nmero de msseis disparados
-		num_missiles += n;
+		// Acorda a defesa, que s dorme o tempo todo quando no tem ameaas
+		if (n > 0) {
+			xTaskNotifyGive(defense_task);
+		}
 
-		printf("ATAQUE");
 		// Aguarda um intervalo aleatrio entre 1 e ATTACK_INTERVAL milissegundos
-		vTaskDelay(random(1, ATTACK_INTERVAL) / portTICK_PERIOD_MS);
+		delay = rng_float(&sim.attack_rng, 1, ATTACK_INTERVAL) / portTICK_PERIOD_MS;
+		rtmon_job_finish(&rt_attack, MS_TO_NS(delay * portTICK_PERIOD_MS));
+		vTaskDelay(delay);
 	}
 }
 
 // Funo da tarefa de defesa
 void defense(void* pvParameters) {
-	// Declara uma varivel para armazenar o nmero de msseis recebidos
-	int n;
+	// Declara variveis para o nmero de interceptores lanados, para o descritor da ameaa e para a espera at a prxima ativao
+	int launched;
+	struct LaunchDescriptor threat;
+	TickType_t wait = portMAX_DELAY;
+
+	rt_register(&rt_defense);
 
 	// Entra em um loop infinito
 	while (1) {
-		// Recebe o nmero de msseis da fila de comunicao
-		xQueueReceive(attack_queue, &n, portMAX_DELAY);
-
-		// Percorre os msseis recebidos
-		for (int i = 0; i < n; i++) {
-			// Verifica se o mssil est direcionado a uma rea habitada
-			if (missiles[i].targeted) {
-				// Lana um interceptor com parmetros calculados para interceptar o mssil
-				launch_interceptor(&interceptors[i], WINDOW_WIDTH, WINDOW_HEIGHT, calculate_angle(&missiles[i]), calculate_speed(&missiles[i]));
-			}
+		double now, wake;
+
+		// Dorme at o instante pedido pelo acmulo ou at o ataque avisar que lanou uma onda
+		ulTaskNotifyTake(pdTRUE, wait);
+		rtmon_job_start(&rt_defense);
+		now = TICKS_TO_SECONDS(xTaskGetTickCount());
+
+		// Acumula as ameaas que chegaram desde a ltima ativao, sem chamadas ao kernel; as que
+		// no couberem ficam no anel para a prxima
+		while (assignment.pending < assignment.capacity && spsc_pop(&threat_ring, &threat)) {
+			// O ataque coloca a ameaa no anel no instante do lanamento
+			hist_record(&queue_wait, SECONDS_TO_NS(now - threat.launch_time));
+			assign_add_threat(&assignment, &threat);
 		}
 
-		// Atualiza o nmero de interceptores disparados
-		num_interceptors += n;
+		// Atribui no mximo config.interceptors_per_defense interceptores s ameaas mais
+		// urgentes, se j passou DEFENSE_INTERVAL desde a ltima salva
+		launched = defense_assign(&sim, &assignment, now, defense_buffer);
+		for (int i = 0; i < launched; i++) {
+			ring_send(&intercept_ring, &defense_buffer[i]);
+		}
 
-		printf("DEFESA");
-		// Aguarda um intervalo de DEFENSE_INTERVAL milissegundos
-		vTaskDelay(DEFENSE_INTERVAL / portTICK_PERIOD_MS);
+		// Acorda na prxima salva permitida enquanto houver ameaas, em vez de a cada DEFENSE_INTERVAL
+		wake = assign_next_wake(&assignment, now);
+		wait = wake == HUGE_VAL ? portMAX_DELAY : SECONDS_TO_TICKS(wake - now);
+		rtmon_job_finish(&rt_defense, 0);
 	}
 }
 
-// Funo da tarefa de monitor
-void monitor(void* pvParameters) {
-	// Entra em um loop infinito
-	while (1) {
-		//vTaskDelay(10 / portTICK_PERIOD_MS);
-		update();
+// Funo que coloca na simulao os msseis e interceptores lanados desde o ltimo passo
+static void launch_pending(void) {
+	struct LaunchDescriptor d;
 
+	while (spsc_pop(&launch_ring, &d)) {
+		launch_missile(&sim, &d);
+	}
+	while (spsc_pop(&intercept_ring, &d)) {
+		if (launch_interceptor(&sim, &d) != ENTITY_NONE) {
+			hist_record(&reaction_time, SECONDS_TO_NS(sim.time - d.threat_time));
+		}
 	}
 }
-// Funo que atualiza o estado do sistema
-void update() {
-	// Percorre os msseis
-	for (int i = 0; i < NUM_MISSILES; i++) {
-		// Verifica se o mssil est ativo
-		if (missiles[i].active) {
-			// Atualiza a posio do mssil de acordo com a sua velocidade e a gravidade
-			missiles[i].x += missiles[i].vx;
-			missiles[i].y += missiles[i].vy;
-			missiles[i].vy += GRAVITY;
-
-			// Verifica se o mssil saiu da janela grfica
-			if (missiles[i].x < 0 || missiles[i].x > WINDOW_WIDTH || missiles[i].y < 0 || missiles[i].y > WINDOW_HEIGHT) {
-				// Desativa o mssil
-				missiles[i].active = 0;
-			}
 
-			// Percorre as reas habitadas
-			for (int j = 0; j < 3; j++) {
-				// Verifica se o mssil est dentro de uma rea habitada
-				if (is_in_area(&missiles[i], &areas[j])) {
-					// Marca a rea como atingida
-					areas[j].hit = 0;
+// Funo da tarefa de monitor
+void monitor(void* pvParameters) {
+	// Perodo da tarefa em ticks e instantes da ltima ativao e do tempo j simulado
+	const TickType_t period = pdMS_TO_TICKS(MONITOR_PERIOD_MS);
+	TickType_t last_wake = xTaskGetTickCount();
+	TickType_t simulated = last_wake;
+	int steps;
+	uint64_t start;
 
-					// Atualiza o nmero de msseis que atingiram as reas
-					num_hits++;
+	// O tempo simulado acompanha o tempo do escalonador
+	sim.time = TICKS_TO_SECONDS(simulated);
+	rt_register(&rt_monitor);
 
-					// Desativa o mssil
-					missiles[i].active = 0;
-				}
+	// Entra em um loop infinito
+	while (1) {
+		// Aguarda a prxima ativao peridica (sem acumular o tempo gasto no update)
+		vTaskDelayUntil(&last_wake, period);
+		rtmon_job_start(&rt_monitor);
+
+		// Avana a simulao em passos fixos at alcanar o tempo real, recuperando ativaes
+		// atrasadas com no mximo MAX_SUBSTEPS passos
+		steps = 0;
+		while ((TickType_t)(xTaskGetTickCount() - simulated) >= period && steps < MAX_SUBSTEPS) {
+			launch_pending();
+			start = host_time_ns();
+			tick_update(&tick_pool, SIM_DT);
+			hist_record(&update_time, host_time_ns() - start);
+			snapshot_publish(&snapshot, &sim);
+			if (record_path != NULL) {
+				recorder_capture(&recorder);
 			}
+			simulated += period;
+			steps++;
 		}
-	}
-
-	// Percorre os interceptores
-	for (int i = 0; i < NUM_INTERCEPTORS; i++) {
-		// Verifica se o interceptor est ativo
-		if (interceptors[i].active) {
-			// Atualiza a posio do interceptor de acordo com a sua velocidade e a gravidade
-			interceptors[i].x += interceptors[i].vx;
-			interceptors[i].y += interceptors[i].vy;
-			interceptors[i].vy += GRAVITY;
 
-			// Verifica se o interceptor saiu da janela grfica
-			if (interceptors[i].x < 0 || interceptors[i].x > WINDOW_WIDTH || interceptors[i].y < 0 || interceptors[i].y > WINDOW_HEIGHT) {
-				// Desativa o interceptor
-				interceptors[i].active = 0;
-			}
-
-			// Percorre os msseis
-			for (int j = 0; j < NUM_MISSILES; j++) {
-				// Verifica se o mssil est ativo e direcionado a uma rea habitada
-				if (missiles[j].active && missiles[j].targeted) {
-					// Verifica se o mssil foi interceptado pelo interceptor
-					if (is_intercepted(&missiles[j], &interceptors[i])) {
-						// Atualiza o nmero de msseis que foram interceptados
-						num_intercepts++;
-
-						// Desativa o mssil e o interceptor
-						missiles[j].active = 0;
-						interceptors[i].active = 0;
-					}
-				}
-			}
+		// Se o atraso for maior do que MAX_SUBSTEPS passos, avana o restante num passo s, para
+		// que as entidades acompanhem o relgio usado pelo ataque e pela defesa. A integrao 
+		// exata e o teste de interceptao varre o passo inteiro; s no h quadro gravado.
+		if ((TickType_t)(xTaskGetTickCount() - simulated) >= period) {
+			TickType_t now = xTaskGetTickCount();
+
+			launch_pending();
+			tick_update(&tick_pool, (float)TICKS_TO_SECONDS(now - simulated));
+			snapshot_publish(&snapshot, &sim);
+			simulated = now;
+			sim.time = TICKS_TO_SECONDS(simulated);
 		}
+		rtmon_job_finish(&rt_monitor, 0);
 	}
 }
 
-void launch_missile(struct Missile* m, float x, float y, float angle, float speed) {
-	// Atribui os valores de x, y, angle e speed ao mssil m
-	m->x = x;
-	m->y = y;
-	m->angle = angle;
-	m->speed = speed;
-
-	// Calcula as componentes x e y da velocidade do mssil
-	m->vx = speed * cos(to_radians(angle));
-	m->vy = speed * sin(to_radians(angle));
+// Funo da tarefa de gravao
+void writer(void* pvParameters) {
+	FILE* f = NULL;
 
-	// Ativa o mssil
-	m->active = 1;
+	fopen_s(&f, record_path, "wb");
+	if (f == NULL || recorder_write_header(&recorder, f) != 0) {
+		printf("Falha ao abrir a gravao %s\r\n", record_path);
+		vTaskDelete(NULL);
+		return;
+	}
 
-	// Verifica se o mssil est direcionado a uma rea habitada
-	m->targeted = 0;
-	for (int i = 0; i < 3; i++) {
-		if (is_in_area(m, &areas[i])) {
-			m->targeted = 1;
-			break;
+	// Entra em um loop infinito
+	while (1) {
+		// Grava as pginas que o monitor entregou desde a ltima ativao
+		if (recorder_drain(&recorder, f) < 0) {
+			printf("Falha ao gravar %s\r\n", record_path);
 		}
+		fflush(f);
+		vTaskDelay(WRITER_PERIOD_MS / portTICK_PERIOD_MS);
 	}
 }
 
-int is_in_area(struct Missile* m, struct Area* a) {
-	
-	if (m->x >= a->x && m->x <= a->x + a->width && m->y >= a->y && m->y <= a->y + a->height) {
-		// O mssil est dentro da rea
-		return 0;
-	}
-	else {
-		// O mssil no est dentro da rea
-		return 1;
+// Funo que regrava o conjunto de tarefas com os tempos medidos at agora
+static void write_task_set(const char* path) {
+	FILE* f = NULL;
+
+	fopen_s(&f, path, "w");
+	if (f == NULL) {
+		printf("Falha ao gravar %s\r\n", path);
+		return;
 	}
+	fprintf(f, "# nome intervalo_us prazo_us wcet_us liberacao\n");
+	rtmon_write(&rt_attack, f);
+	rtmon_write(&rt_defense, f);
+	rtmon_write(&rt_monitor, f);
+	fclose(f);
 }
 
-int is_intercepted(struct Missile* m1, struct Missile* m2) {
-	
-	float tolerance = 10.0;
-	float distance = sqrt((m1->x - m2->x) * (m1->x - m2->x) + (m1->y - m2->y) * (m1->y - m2->y));
-
-	if (distance <= tolerance) {
-		// Os msseis se interceptaram
-		return 1;
-	}
-	else {
-		// Os msseis no se interceptaram
-		return 0;
+// Funo da tarefa de relatrio: imprime os contadores e os histogramas, lidos sem travas
+void report(void* pvParameters) {
+	// Entra em um loop infinito
+	while (1) {
+		vTaskDelay(REPORT_PERIOD_MS / portTICK_PERIOD_MS);
+
+		printf("\r\nMsseis %u  interceptores %u  acertos %u  interceptaes %u  descartes %u\r\n",
+			stats_read(&sim.counters, STATS_MISSILES), stats_read(&sim.counters, STATS_INTERCEPTORS),
+			stats_read(&sim.counters, STATS_HITS), stats_read(&sim.counters, STATS_INTERCEPTS),
+			stats_read(&sim.counters, STATS_DROPPED));
+		hist_print(&update_time, "update()", stdout);
+		hist_print(&queue_wait, "Espera da defesa", stdout);
+		hist_print(&reaction_time, "Tempo de reao", stdout);
+		rtmon_print(&rt_attack, stdout);
+		rtmon_print(&rt_defense, stdout);
+		rtmon_print(&rt_monitor, stdout);
+		if (rt_log_path != NULL) {
+			write_task_set(rt_log_path);
+		}
 	}
 }
 
-float random(float min, float max) {
-	
-	// Gera um nmero inteiro entre 0 e RAND_MAX
-	int r = rand();
-
-	// Converte o nmero inteiro em um nmero decimal entre 0 e 1
-	float f = (float)r / RAND_MAX;
+// Funo da tarefa de desenho: a cada render_period_ms desenha o ltimo quadro publicado pelo
+// monitor, em ASCII ou como arquivo PPM. Se a cpia colidir com o monitor, espera o prximo perodo.
+void render(void* pvParameters) {
+	const TickType_t period = pdMS_TO_TICKS(render_period_ms);
+	TickType_t last_wake = xTaskGetTickCount();
+	char path[RENDER_PATH_LENGTH];
+	unsigned int frame = 0;
+	FILE* f;
 
-	// Converte o nmero decimal entre 0 e 1 em um nmero decimal entre min e max
-	float result = min + f * (max - min);
-
-	// Retorna o resultado
-	return result;
-}
+	// Entra em um loop infinito
+	while (1) {
+		vTaskDelayUntil(&last_wake, period);
 
-// Talvez precise
-float to_radians(float degrees) {
+		if (!snapshot_read(&snapshot, &render_frame)) {
+			continue;
+		}
 
-	// Converte graus em radianos usando a frmula
-	float radians = degrees * PI / 180;
+		if (ppm_prefix == NULL) {
+			render_ascii(&render_frame, &sim.config, sim.areas, stdout);
+			continue;
+		}
 
-	// Retorna o resultado
-	return radians;
+		snprintf(path, sizeof(path), "%s%06u.ppm", ppm_prefix, frame++);
+		f = NULL;
+		fopen_s(&f, path, "wb");
+		if (f == NULL || render_ppm(&render_frame, &sim.config, sim.areas, ppm_pixels, f) != 0) {
+			printf("Falha ao gravar %s\r\n", path);
+		}
+		if (f != NULL) {
+			fclose(f);
+		}
+	}
 }
 
-float to_degrees(float radians) {
-
-	// Converte radianos em graus usando a frmula
-	float degrees = radians * 180 / PI;
-
-	// Retorna o resultado
-	return degrees;
+// Funo que envia um descritor para um anel, cedendo o processador enquanto ele estiver cheio
+void ring_send(struct SpscRing* r, const struct LaunchDescriptor* d) {
+	while (!spsc_push(r, d)) {
+		vTaskDelay(1);
+	}
 }
 
-void launch_interceptor(struct Missile* m, float x, float y, float angle, float speed) {
-	// Atribui os valores de x, y, angle e speed ao interceptor m
-	m->x = x;
-	m->y = y;
-	m->angle = angle;
-	m->speed = speed;
+// Funo que l as reas habitadas de um arquivo (formato de areas_load) para config. A
+// memria fica com o programa at o fim, porque os cenrios em lote compartilham a lista.
+static int load_area_file(const char* path, struct SimConfig* config) {
+	FILE* f = NULL;
+	int n;
 
-	// Calcula as componentes x e y da velocidade do interceptor
-	// Note que a velocidade x  negativa, pois o interceptor  lanado da direita para a esquerda
-	m->vx = -speed * cos(to_radians(angle));
-	m->vy = speed * sin(to_radians(angle));
+	fopen_s(&f, path, "r");
+	if (f == NULL) {
+		printf("Falha ao abrir o arquivo de reas %s\r\n", path);
+		return -1;
+	}
 
-	// Ativa o interceptor
-	m->active = 1;
+	// Conta as reas, reserva o vetor e l de novo
+	n = areas_load(f, NULL, MAX_AREAS);
+	if (n > 0) {
+		area_file = malloc((size_t)n * sizeof(struct Area));
+		rewind(f);
+		n = area_file != NULL ? areas_load(f, area_file, n) : -1;
+	}
+	fclose(f);
+	if (n <= 0) {
+		printf("Arquivo de reas invlido, vazio ou com mais de %d reas: %s\r\n", MAX_AREAS, path);
+		return -1;
+	}
 
-	// No  necessrio verificar se o interceptor est direcionado a uma rea habitada, pois ele s  lanado para interceptar msseis que j esto
-	// indo para uma area habitada
+	config->num_areas = n;
+	config->area_list = area_file;
+	return 0;
 }
-float calculate_angle(struct Missile* m) {
 
-	// Calcula a distncia horizontal entre o interceptor e o mssil
-	float dx = m->x - WINDOW_WIDTH;
+// Funo que l as opes --nome=valor de configurao da simulao e as retira de argv.
+// "--stress" escolhe o cenrio de estresse com 10^5 msseis, "--record=arquivo" grava o estado da
+// simulao a cada passo, "--rt-log=arquivo" grava os tempos das tarefas para tools/schedcheck.c,
+// "--areas-file=arquivo" l as reas habitadas de um arquivo (e ignora --areas),
+// "--render-period=ms" muda o perodo do desenho (0 desliga),
+// "--tick-threads=n" divide cada passo do monitor entre n threads do hospedeiro (0 usa todos os ncleos),
+// "--seed=n" muda a semente dos geradores aleatrios (tambm a do modo em lote, se ele no receber outra) e
+// "--ppm=prefixo" desenha em arquivos PPM em vez de ASCII. Retorna o novo argc, ou -1 se
+// alguma opo for desconhecida.
+int parse_config(int argc, char** argv, struct SimConfig* config) {
+	const char* areas_path = NULL;
+	int kept = 1;
+
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = strchr(arg, '=');
+
+		if (strcmp(arg, "--stress") == 0) {
+			config->missiles_per_wave = 10000;
+			config->interceptors_per_defense = 5000;
+			config->max_missiles = 100000;
+			config->max_interceptors = 50000;
+			config->ring_capacity = 32768;
+		}
+		else if (strncmp(arg, "--", 2) != 0 || value == NULL) {
+			// No  uma opo de configurao: fica para o restante do programa
+			argv[kept++] = argv[i];
+		}
+		else if (strncmp(arg, "--record=", 9) == 0) {
+			record_path = value + 1;
+		}
+		else if (strncmp(arg, "--rt-log=", 9) == 0) {
+			rt_log_path = value + 1;
+		}
+		else if (strncmp(arg, "--render-period=", 16) == 0) {
+			render_period_ms = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--ppm=", 6) == 0) {
+			ppm_prefix = value + 1;
+		}
+		else if (strncmp(arg, "--tick-threads=", 15) == 0) {
+			tick_threads = atoi(value + 1);
+			if (tick_threads <= 0) {
+				tick_threads = host_cpu_count();
+			}
+			if (tick_threads > TICK_MAX_THREADS) {
+				tick_threads = TICK_MAX_THREADS;
+			}
+		}
+		else if (strncmp(arg, "--missiles=", 11) == 0) {
+			config->missiles_per_wave = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--interceptors=", 15) == 0) {
+			config->interceptors_per_defense = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--max-missiles=", 15) == 0) {
+			config->max_missiles = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--max-interceptors=", 19) == 0) {
+			config->max_interceptors = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--areas=", 8) == 0) {
+			config->num_areas = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--areas-file=", 13) == 0) {
+			areas_path = value + 1;
+		}
+		else if (strncmp(arg, "--launchers=", 12) == 0) {
+			config->num_launchers = atoi(value + 1);
+		}
+		else if (strncmp(arg, "--ring=", 7) == 0) {
+			config->ring_capacity = (unsigned int)strtoul(value + 1, NULL, 10);
+		}
+		else if (strncmp(arg, "--width=", 8) == 0) {
+			config->width = (float)atof(value + 1);
+		}
+		else if (strncmp(arg, "--height=", 9) == 0) {
+			config->height = (float)atof(value + 1);
+		}
+		else if (strncmp(arg, "--seed=", 7) == 0) {
+			config->seed = strtoull(value + 1, NULL, 10);
+		}
+		else {
+			printf("Opo desconhecida: %s\r\n", arg);
+			return -1;
+		}
+	}
 
-	// Calcula a distncia vertical entre o interceptor e o mssil
-	float dy = WINDOW_HEIGHT - m->y;
+	// O arquivo de reas  lido depois das outras opes, para que o nmero de reas seja o dele
+	if (areas_path != NULL && load_area_file(areas_path, config) != 0) {
+		return -1;
+	}
 
-	// Calcula o ngulo de lanamento do interceptor usando a frmula
-	float angle = atan2(dy, dx);
+#if SIM_FIXED_POINT
+	if (config->width > SIM_FIXED_MAX_EXTENT || config->height > SIM_FIXED_MAX_EXTENT) {
+		printf("Em ponto fixo --width e --height vo at %.0f\r\n", SIM_FIXED_MAX_EXTENT);
+		return -1;
+	}
+#endif
 
-	// Converte o ngulo de radianos para graus
-	angle = to_degrees(angle);
+	// Uma onda inteira precisa caber nos anis, seno o ataque nunca consegue dispar-la
+	if (config->missiles_per_wave > 0 && config->ring_capacity < (unsigned int)config->missiles_per_wave) {
+		printf("--ring=%u no comporta uma onda de %d msseis (--missiles)\r\n", config->ring_capacity, config->missiles_per_wave);
+		return -1;
+	}
 
-	// Retorna o resultado
-	return angle;
+	argv[kept] = NULL;
+	return kept;
 }
 
-float calculate_speed(struct Missile* m) {
+// Funo que executa o modo em lote: [cenrios] [threads] [durao em segundos] [semente] [eventos]
+int run_batch(int argc, char** argv, const struct SimConfig* sim_config) {
+	struct BatchConfig config;
+	struct BatchResult result;
 
-	// Calcula a distncia horizontal entre o interceptor e o mssil
-	float dx = m->x - WINDOW_WIDTH;
+	config.scenarios = argc > 0 ? atoi(argv[0]) : BATCH_DEFAULT_SCENARIOS;
+	config.threads = argc > 1 ? atoi(argv[1]) : 0;
+	config.duration = argc > 2 ? (float)atof(argv[2]) : BATCH_DEFAULT_DURATION;
+	config.seed = argc > 3 ? strtoull(argv[3], NULL, 10) : sim_config->seed;
+	config.events = argc > 4 ? atoi(argv[4]) : 0;
+	config.sim = *sim_config;
 
-	// Calcula a distncia vertical entre o interceptor e o mssil
-	float dy = WINDOW_HEIGHT - m->y;
+	if (batch_run(&config, &result) != 0) {
+		printf("Falha ao executar o lote\r\n");
+		return 1;
+	}
 
-	// Calcula o ngulo de lanamento do interceptor usando a funo calculate_angle
-	float angle = calculate_angle(m);
+	batch_print(&result, stdout);
+	return 0;
+}
 
-	// Converte o ngulo de graus para radianos
-	angle = to_radians(angle);
+// Funo que reproduz uma gravao: arquivo [intervalo em segundos]. Avana pelo arquivo mapeado
+// imprimindo os contadores a cada intervalo e termina com as mesmas estatsticas do modo em lote.
+int run_replay(int argc, char** argv) {
+	struct Replay replay;
+	struct ScenarioResult scenario;
+	struct BatchResult result;
+	double v[1];
+	float interval = argc > 1 ? (float)atof(argv[1]) : 0;
+
+	if (argc < 1 || replay_open(&replay, argv[0]) != 0) {
+		printf("Falha ao abrir a gravao\r\n");
+		return 1;
+	}
+	printf("Gravao: %d quadros (%d quadros-chave), passos %lu a %lu\r\n", replay.num_frames, replay.num_keys,
+		(unsigned long)replay.first_tick, (unsigned long)replay.last_tick);
+
+	// Avana em saltos de intervalo segundos; cada salto decodifica s os quadros do caminho
+	if (interval > 0) {
+		int64_t stride = (int64_t)(interval / replay.dt);
+
+		for (int64_t t = replay.first_tick; t < replay.last_tick; t += stride > 0 ? stride : 1) {
+			replay_seek(&replay, t);
+			printf("%10.2f s  msseis %u  interceptores %u  acertos %u  interceptaes %u\r\n", replay.sim.time,
+				stats_read(&replay.sim.counters, STATS_MISSILES), stats_read(&replay.sim.counters, STATS_INTERCEPTORS),
+				stats_read(&replay.sim.counters, STATS_HITS), stats_read(&replay.sim.counters, STATS_INTERCEPTS));
+		}
+	}
 
-	// Calcula a velocidade de lanamento do interceptor usando a frmula
-	float speed = sqrt((GRAVITY * dx * dx) / (2 * (dy - dx * tan(angle)) * cos(angle) * cos(angle)));
+	// Estado final, agregado pelo mesmo cdigo do modo em lote
+	replay_seek(&replay, replay.last_tick);
+	batch_collect(&replay.sim, &scenario);
+	batch_summarize(&scenario, 1, v, &result);
+	batch_print(&result, stdout);
 
-	// Retorna o resultado
-	return speed;
+	replay_close(&replay);
+	return 0;
 }
 
 
@@ -715,6 +950,70 @@ const HeapRegion_t xHeapRegions[] =
 }
 /*-----------------------------------------------------------*/
 
+static int prvInitialiseArena( const struct SimConfig *pxConfig )
+{
+static uint8_t ucArena[ mainARENA_SIZE ];
+size_t xRingBytes = SPSC_RING_BYTES( pxConfig->ring_capacity, sizeof( struct LaunchDescriptor ) );
+void *pvLaunch, *pvThreat, *pvIntercept;
+
+	arena_init( &arena, ucArena, sizeof( ucArena ) );
+
+	// Simulao (entidades, grade e reas), anis de descritores e onda de ataque
+	if( sim_create( &sim, pxConfig, &arena ) != 0 )
+	{
+		return -1;
+	}
+
+	pvLaunch = arena_alloc( &arena, xRingBytes, sizeof( double ) );
+	pvThreat = arena_alloc( &arena, xRingBytes, sizeof( double ) );
+	pvIntercept = arena_alloc( &arena, xRingBytes, sizeof( double ) );
+	attack_buffer = arena_alloc( &arena, pxConfig->missiles_per_wave * sizeof( struct LaunchDescriptor ), sizeof( double ) );
+	if( pvLaunch == NULL || pvThreat == NULL || pvIntercept == NULL || attack_buffer == NULL )
+	{
+		return -1;
+	}
+
+	// Acmulo de ameaas e interceptores de uma ativao da defesa
+	defense_buffer = arena_alloc( &arena, pxConfig->interceptors_per_defense * sizeof( struct LaunchDescriptor ), sizeof( double ) );
+	if( defense_buffer == NULL || assign_create( &assignment, pxConfig, &arena ) != 0 )
+	{
+		return -1;
+	}
+
+	spsc_init( &launch_ring, pxConfig->ring_capacity, sizeof( struct LaunchDescriptor ), pvLaunch );
+	spsc_init( &threat_ring, pxConfig->ring_capacity, sizeof( struct LaunchDescriptor ), pvThreat );
+	spsc_init( &intercept_ring, pxConfig->ring_capacity, sizeof( struct LaunchDescriptor ), pvIntercept );
+
+	// Buffers publicados pelo monitor, cpia da tarefa de desenho e imagem dos quadros PPM
+	if( snapshot_create( &snapshot, pxConfig, &arena ) != 0 || snapshot_frame_create( &render_frame, pxConfig, &arena ) != 0 )
+	{
+		return -1;
+	}
+	if( ppm_prefix != NULL )
+	{
+		ppm_pixels = arena_alloc( &arena, RENDER_PPM_BYTES( pxConfig ), 1 );
+		if( ppm_pixels == NULL )
+		{
+			return -1;
+		}
+	}
+
+	// Threads de trabalho do passo paralelo (com uma s, tick_update chama update() diretamente)
+	if( tick_create( &tick_pool, &sim, tick_threads, &arena ) != 0 )
+	{
+		return -1;
+	}
+
+	// Pginas e estado do ltimo quadro do gravador, s quando h gravao
+	if( record_path != NULL && recorder_create( &recorder, &sim, &arena ) != 0 )
+	{
+		return -1;
+	}
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
 /* configUSE_STATIC_ALLOCATION is set to 1, so the application must provide an
 implementation of vApplicationGetIdleTaskMemory() to provide the memory that is
 used by the Idle task. */
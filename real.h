@@ -0,0 +1,68 @@
+#ifndef REAL_H
+#define REAL_H
+
+#include <stdint.h>
+
+#include "fixed.h"
+
+// Tipo numrico do estado da simulao. Com SIM_FIXED_POINT = 0 (padro)  float; com 1 
+// ponto fixo Q16.16 (fixed.h), e posies, velocidades, a integrao, a grade, o teste de
+// interceptao, a balstica e a trigonometria passam a usar s inteiros, com resultados
+// idnticos bit a bit em qualquer mquina. As interfaces continuam recebendo e devolvendo float.
+#if !defined(SIM_FIXED_POINT)
+#define SIM_FIXED_POINT 0
+#endif
+
+#if SIM_FIXED_POINT
+
+typedef fixed_t real_t;
+typedef int64_t real_wide_t; // Tipo dos produtos de dois real_t sem arredondamento
+
+static inline real_t real_from_float(float v) {
+	return fx_from_double(v);
+}
+
+static inline real_t real_from_double(double v) {
+	return fx_from_double(v);
+}
+
+static inline float real_to_float(real_t v) {
+	return (float)fx_to_double(v);
+}
+
+static inline double real_to_double(real_t v) {
+	return fx_to_double(v);
+}
+
+static inline real_t real_mul(real_t a, real_t b) {
+	return fx_mul(a, b);
+}
+
+#else
+
+typedef float real_t;
+typedef float real_wide_t;
+
+static inline real_t real_from_float(float v) {
+	return v;
+}
+
+static inline real_t real_from_double(double v) {
+	return (float)v;
+}
+
+static inline float real_to_float(real_t v) {
+	return v;
+}
+
+static inline double real_to_double(real_t v) {
+	return v;
+}
+
+static inline real_t real_mul(real_t a, real_t b) {
+	return a * b;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,289 @@
+#include <math.h>
+#include <string.h>
+
+#include "recorder.h"
+
+// Bytes do incio de cada quadro que no dependem do nmero de entidades: cabealho do quadro,
+// os quatro contadores, bits das reas e as duas quantidades
+#define RECORDER_FRAME_FIXED_BYTES (RECORDER_FRAME_HEADER_BYTES + 6 * 5 + (MAX_AREAS + 7) / 8)
+
+// Funo que calcula o maior quadro possvel para as capacidades arredondadas m e i
+static size_t max_frame_bytes(size_t m, size_t i) {
+	return RECORDER_FRAME_FIXED_BYTES + (m + i) * RECORDER_MAX_RECORD_BYTES;
+}
+
+// Funo que calcula o tamanho das pginas: cabem pelo menos um quadro completo
+static size_t page_bytes(size_t m, size_t i) {
+	size_t frame = max_frame_bytes(m, i);
+	return frame > RECORDER_MIN_PAGE_BYTES ? frame : RECORDER_MIN_PAGE_BYTES;
+}
+
+size_t recorder_arena_bytes(const struct SimConfig* config) {
+	size_t m = ENTITY_ROUND_CAPACITY(config->max_missiles);
+	size_t i = ENTITY_ROUND_CAPACITY(config->max_interceptors);
+
+	return RECORDER_PAGES * ARENA_BYTES(page_bytes(m, i), sizeof(double))
+		+ 2 * ARENA_BYTES((m + i) * sizeof(int32_t), sizeof(int32_t))
+		+ ARENA_BYTES(m + i, 1)
+		+ ARENA_BYTES((m + i) / 8, sizeof(uint32_t));
+}
+
+int recorder_create(struct Recorder* r, const struct Simulation* sim, struct Arena* arena) {
+	// Usa as mesmas capacidades arredondadas que entities_init d aos armazenamentos
+	size_t m = ENTITY_ROUND_CAPACITY(sim->config.max_missiles);
+	size_t i = ENTITY_ROUND_CAPACITY(sim->config.max_interceptors);
+
+	r->sim = sim;
+	r->frame_bytes = max_frame_bytes(m, i);
+	r->page_bytes = page_bytes(m, i);
+	for (int k = 0; k < RECORDER_PAGES; k++) {
+		r->pages[k].data = arena_alloc(arena, r->page_bytes, sizeof(double));
+		r->pages[k].used = 0;
+		if (r->pages[k].data == NULL) {
+			return -1;
+		}
+	}
+
+	// Os interceptores ficam depois dos msseis nos vetores do quadro anterior
+	r->prev_x = arena_alloc(arena, (m + i) * sizeof(int32_t), sizeof(int32_t));
+	r->prev_y = arena_alloc(arena, (m + i) * sizeof(int32_t), sizeof(int32_t));
+	r->prev_generation = arena_alloc(arena, m + i, 1);
+	r->prev_present = arena_alloc(arena, (m + i) / 8, sizeof(uint32_t));
+	if (r->prev_x == NULL || r->prev_y == NULL || r->prev_generation == NULL || r->prev_present == NULL) {
+		return -1;
+	}
+	memset(r->prev_present, 0, (m + i) / 8);
+
+	// Todas as pginas comeam livres
+	spsc_init(&r->free_pages, RECORDER_PAGES, sizeof(int), r->free_storage);
+	spsc_init(&r->full_pages, RECORDER_PAGES, sizeof(int), r->full_storage);
+	for (int k = 0; k < RECORDER_PAGES; k++) {
+		spsc_push(&r->free_pages, &k);
+	}
+
+	r->current = -1;
+	r->page_frames = 0;
+	r->frame = 0;
+	r->since_key = 0;
+	r->force_key = 1;
+	r->frames_recorded = 0;
+	r->frames_dropped = 0;
+	r->bytes_written = 0;
+	return 0;
+}
+
+// Funes que escrevem inteiros em little-endian e avanam o cursor
+static uint8_t* put_u16(uint8_t* p, uint32_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	return p + 2;
+}
+
+static uint8_t* put_u32(uint8_t* p, uint32_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+	return p + 4;
+}
+
+static uint8_t* put_f32(uint8_t* p, float v) {
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return put_u32(p, bits);
+}
+
+static uint8_t* put_f64(uint8_t* p, double v) {
+	uint64_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	p = put_u32(p, (uint32_t)bits);
+	return put_u32(p, (uint32_t)(bits >> 32));
+}
+
+// Funo que escreve um inteiro sem sinal em 7 bits por byte, com o bit alto indicando continuao
+static uint8_t* put_varint(uint8_t* p, uint32_t v) {
+	while (v >= 0x80) {
+		*p++ = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+}
+
+// Funo que escreve um inteiro com sinal em zigzag (0, -1, 1, -2, ... viram 0, 1, 2, 3, ...)
+static uint8_t* put_svarint(uint8_t* p, int32_t v) {
+	return put_varint(p, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+// Funo que quantiza uma coordenada (em ponto fixo, s com inteiros)
+static int32_t quantize(real_t v) {
+#if SIM_FIXED_POINT
+	return (int32_t)fx_round_shift((int64_t)v * RECORDER_QUANTUM, FX_SHIFT);
+#else
+	return (int32_t)lrintf(v * RECORDER_QUANTUM);
+#endif
+}
+
+// Funo que codifica as entidades ativas de um armazenamento. base  a posio do armazenamento
+// nos vetores do quadro anterior, que so atualizados com o estado codificado.
+static uint8_t* encode_store(struct Recorder* r, const struct EntityStore* s, int base, int key, uint8_t* p) {
+	int words = s->capacity / ENTITY_MASK_BITS;
+	int count = 0;
+	int last = -1;
+	uint32_t* present = r->prev_present + base / ENTITY_MASK_BITS;
+
+	for (int w = 0; w < words; w++) {
+		count += entities_popcount(s->active[w]);
+	}
+	p = put_varint(p, (uint32_t)count);
+
+	for (int i = entities_next_active(s, 0); i >= 0; i = entities_next_active(s, i + 1)) {
+		int k = base + i;
+		int32_t qx = quantize(s->x[i]);
+		int32_t qy = quantize(s->y[i]);
+		// Uma entidade  nova se no estava no quadro anterior ou se o ndice foi reutilizado
+		int fresh = key || !((present[i / ENTITY_MASK_BITS] >> (i % ENTITY_MASK_BITS)) & 1)
+			|| r->prev_generation[k] != s->generation[i];
+
+		p = put_varint(p, ((uint32_t)(i - last - 1) << 1) | (uint32_t)fresh);
+		if (fresh) {
+			*p++ = s->generation[i];
+			p = put_svarint(p, qx);
+			p = put_svarint(p, qy);
+		}
+		else {
+			p = put_svarint(p, qx - r->prev_x[k]);
+			p = put_svarint(p, qy - r->prev_y[k]);
+		}
+
+		r->prev_x[k] = qx;
+		r->prev_y[k] = qy;
+		r->prev_generation[k] = s->generation[i];
+		last = i;
+	}
+
+	memcpy(present, s->active, (size_t)words * sizeof(uint32_t));
+	return p;
+}
+
+// Funo que entrega a pgina em preenchimento para a tarefa de gravao
+static void submit_page(struct Recorder* r) {
+	if (r->current >= 0) {
+		// H tantas posies no anel quanto pginas, ento a entrega nunca falha
+		spsc_push(&r->full_pages, &r->current);
+		r->current = -1;
+		r->page_frames = 0;
+	}
+}
+
+void recorder_capture(struct Recorder* r) {
+	const struct Simulation* sim = r->sim;
+	uint32_t frame = r->frame++;
+	struct RecorderPage* page;
+	uint8_t *start, *p;
+	int key;
+
+	// Garante espao para o maior quadro possvel, trocando de pgina se for preciso
+	if (r->current >= 0 && r->pages[r->current].used + r->frame_bytes > r->page_bytes) {
+		submit_page(r);
+	}
+	if (r->current < 0) {
+		if (!spsc_pop(&r->free_pages, &r->current)) {
+			// A gravao est atrasada: descarta o quadro sem tocar no estado do quadro anterior
+			r->current = -1;
+			r->frames_dropped++;
+			r->force_key = 1;
+			return;
+		}
+		r->pages[r->current].used = 0;
+	}
+
+	key = r->force_key || r->since_key >= RECORDER_KEYFRAME_INTERVAL;
+	page = &r->pages[r->current];
+	start = page->data + page->used;
+	p = start + RECORDER_FRAME_HEADER_BYTES;
+
+	p = put_varint(p, stats_read(&sim->counters, STATS_MISSILES));
+	p = put_varint(p, stats_read(&sim->counters, STATS_INTERCEPTORS));
+	p = put_varint(p, stats_read(&sim->counters, STATS_HITS));
+	p = put_varint(p, stats_read(&sim->counters, STATS_INTERCEPTS));
+	for (int a = 0; a < sim->config.num_areas; a += 8) {
+		uint8_t bits = 0;
+		for (int b = 0; b < 8 && a + b < sim->config.num_areas; b++) {
+			bits |= (uint8_t)((sim->areas[a + b].hit != 0) << b);
+		}
+		*p++ = bits;
+	}
+	p = encode_store(r, &sim->missiles, 0, key, p);
+	p = encode_store(r, &sim->interceptors, sim->missiles.capacity, key, p);
+
+	// Cabealho do quadro, agora que o tamanho do contedo  conhecido
+	start[0] = key ? RECORDER_FRAME_KEY : RECORDER_FRAME_DELTA;
+	put_u32(start + 1, frame);
+	put_f64(start + 5, sim->time);
+	put_u32(start + 13, (uint32_t)(p - start - RECORDER_FRAME_HEADER_BYTES));
+	page->used = (size_t)(p - page->data);
+
+	r->since_key = key ? 1 : r->since_key + 1;
+	r->force_key = 0;
+	r->frames_recorded++;
+	if (++r->page_frames >= RECORDER_FLUSH_FRAMES) {
+		submit_page(r);
+	}
+}
+
+void recorder_flush(struct Recorder* r) {
+	submit_page(r);
+}
+
+int recorder_write_header(struct Recorder* r, FILE* f) {
+	const struct Simulation* sim = r->sim;
+	uint8_t header[RECORDER_HEADER_BYTES(0)];
+	uint8_t area[RECORDER_HEADER_BYTES(1) - RECORDER_HEADER_BYTES(0)];
+	uint8_t* p = header;
+
+	memcpy(p, "MREC", 4);
+	p = put_u16(p + 4, RECORDER_VERSION);
+	p = put_u16(p, RECORDER_QUANTUM);
+	p = put_f32(p, SIM_DT);
+	p = put_f32(p, sim->config.width);
+	p = put_f32(p, sim->config.height);
+	p = put_u32(p, RECORDER_KEYFRAME_INTERVAL);
+	p = put_u32(p, (uint32_t)sim->missiles.capacity);
+	p = put_u32(p, (uint32_t)sim->interceptors.capacity);
+	p = put_u32(p, (uint32_t)sim->config.num_areas);
+	if (fwrite(header, 1, sizeof(header), f) != sizeof(header)) {
+		return -1;
+	}
+
+	// As reas vo uma a uma, porque podem ser milhares
+	for (int a = 0; a < sim->config.num_areas; a++) {
+		p = put_f32(area, sim->areas[a].x);
+		p = put_f32(p, sim->areas[a].y);
+		p = put_f32(p, sim->areas[a].width);
+		put_f32(p, sim->areas[a].height);
+		if (fwrite(area, 1, sizeof(area), f) != sizeof(area)) {
+			return -1;
+		}
+	}
+	r->bytes_written += RECORDER_HEADER_BYTES(sim->config.num_areas);
+	return 0;
+}
+
+int recorder_drain(struct Recorder* r, FILE* f) {
+	int k, pages = 0;
+
+	while (spsc_pop(&r->full_pages, &k)) {
+		struct RecorderPage* page = &r->pages[k];
+
+		if (fwrite(page->data, 1, page->used, f) != page->used) {
+			// Devolve a pgina mesmo assim, para o monitor no ficar sem pginas
+			spsc_push(&r->free_pages, &k);
+			return -1;
+		}
+		r->bytes_written += page->used;
+		spsc_push(&r->free_pages, &k);
+		pages++;
+	}
+	return pages;
+}
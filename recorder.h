@@ -0,0 +1,94 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "ring.h"
+#include "simulation.h"
+
+// Gravao do estado da simulao a cada passo, em formato binrio compacto.
+//
+// Arquivo: cabealho (RECORDER_HEADER_BYTES bytes, inteiros em little-endian)
+//   "MREC", verso (u16), quantum (u16, fraes de unidade por posio), dt (f32), largura e
+//   altura (f32), intervalo entre quadros-chave (u32), capacidades de msseis e interceptores
+//   (u32), nmero de reas (u32) e depois x, y, largura e altura de cada rea (f32).
+// Em seguida os quadros, um por passo gravado, nunca divididos entre pginas:
+//   tipo (u8, 'K' quadro-chave ou 'D' delta), nmero do passo (u32), tempo simulado (f64),
+//   tamanho do contedo (u32) e o contedo:
+//   num_missiles, num_interceptors, num_hits, num_intercepts (varint), bits das reas atingidas
+//   (1 bit por rea), e para os msseis e depois os interceptores: quantidade (varint) e um
+//   registro por entidade ativa, em ordem de ndice. Cada registro comea com o varint (salto << 1 | novo), em que salto  a
+//   distncia ao ndice anterior menos 1. Uma entidade nova (ou qualquer uma num quadro-chave)
+//   traz a gerao (u8) e a posio quantizada absoluta; as outras trazem s a diferena para
+//   a posio do quadro anterior. Inteiros com sinal usam codificao zigzag.
+//
+// O monitor codifica cada passo numa pgina em memria (recorder_capture) e entrega as pginas
+// cheias a uma tarefa de baixa prioridade que as grava (recorder_drain). Se no houver pgina
+// livre o quadro  descartado e o prximo vira quadro-chave, ento a gravao nunca bloqueia update().
+
+#define RECORDER_VERSION 2 // Verso do formato
+#define RECORDER_QUANTUM 16 // Fraes de unidade por passo de quantizao das posies
+#define RECORDER_KEYFRAME_INTERVAL 100 // Passos entre quadros-chave
+#define RECORDER_PAGES 4 // Nmero de pginas (potncia de 2)
+#define RECORDER_MIN_PAGE_BYTES 65536 // Tamanho mnimo de cada pgina
+#define RECORDER_FLUSH_FRAMES 100 // Nmero mximo de quadros numa pgina antes de entreg-la
+#define RECORDER_FRAME_KEY 'K' // Tipo do quadro-chave
+#define RECORDER_FRAME_DELTA 'D' // Tipo do quadro delta
+#define RECORDER_FRAME_HEADER_BYTES 17 // Tipo, passo, tempo e tamanho do contedo
+#define RECORDER_HEADER_BYTES(areas) (36 + 16 * (size_t)(areas)) // Tamanho do cabealho do arquivo
+#define RECORDER_MAX_RECORD_BYTES 16 // Maior registro de uma entidade (salto, gerao e posio)
+
+// Pgina de quadros codificados
+struct RecorderPage {
+	uint8_t* data; // Contedo
+	size_t used; // Bytes usados
+};
+
+// Gravador. recorder_capture e recorder_flush so chamados s pelo monitor;
+// recorder_write_header e recorder_drain s pela tarefa de gravao.
+struct Recorder {
+	const struct Simulation* sim; // Simulao gravada
+	size_t frame_bytes; // Tamanho do maior quadro possvel
+	size_t page_bytes; // Tamanho de cada pgina
+	struct RecorderPage pages[RECORDER_PAGES]; // Pginas
+	struct SpscRing free_pages; // ndices das pginas livres, da tarefa de gravao para o monitor
+	struct SpscRing full_pages; // ndices das pginas cheias, do monitor para a tarefa de gravao
+	int free_storage[RECORDER_PAGES]; // Memria do anel de pginas livres
+	int full_storage[RECORDER_PAGES]; // Memria do anel de pginas cheias
+	int current; // Pgina em preenchimento, ou -1
+	int page_frames; // Quadros na pgina em preenchimento
+	int32_t* prev_x; // Posio x quantizada de cada entidade no ltimo quadro gravado
+	int32_t* prev_y; // Posio y quantizada de cada entidade no ltimo quadro gravado
+	uint8_t* prev_generation; // Gerao de cada entidade no ltimo quadro gravado
+	uint32_t* prev_present; // Mscara das entidades presentes no ltimo quadro gravado
+	uint32_t frame; // Nmero do prximo passo
+	uint32_t since_key; // Passos desde o ltimo quadro-chave
+	int force_key; // O prximo quadro precisa ser quadro-chave
+	uint32_t frames_recorded; // Quadros codificados
+	uint32_t frames_dropped; // Quadros descartados por falta de pgina livre
+	uint64_t bytes_written; // Bytes gravados (escrito s pela tarefa de gravao)
+};
+
+// Calcula quantos bytes de arena recorder_create usa para uma configurao
+size_t recorder_arena_bytes(const struct SimConfig* config);
+
+// Cria um gravador para uma simulao criada por sim_create, reservando as pginas na arena. Retorna 0 se conseguiu.
+int recorder_create(struct Recorder* r, const struct Simulation* sim, struct Arena* arena);
+
+// Codifica o estado atual da simulao como um quadro (monitor, depois de cada update)
+void recorder_capture(struct Recorder* r);
+
+// Entrega a pgina em preenchimento para a gravao, mesmo que no esteja cheia (monitor)
+void recorder_flush(struct Recorder* r);
+
+// Grava o cabealho do arquivo (tarefa de gravao, antes de recorder_drain). Retorna 0 se conseguiu.
+int recorder_write_header(struct Recorder* r, FILE* f);
+
+// Grava as pginas cheias e as devolve ao monitor (tarefa de gravao).
+// Retorna o nmero de pginas gravadas, ou -1 em caso de erro de escrita.
+int recorder_drain(struct Recorder* r, FILE* f);
+
+#endif
@@ -0,0 +1,90 @@
+#include <string.h>
+
+#include "render.h"
+
+// Funo que converte uma posio da janela numa clula de uma grade de cols x rows, ou retorna 0
+// se a posio estiver fora da janela
+static int to_cell(float x, float y, const struct SimConfig* config, int cols, int rows, int* c, int* r) {
+	if (x < 0 || y < 0 || x >= config->width || y >= config->height) {
+		return 0;
+	}
+	*c = (int)(x * cols / config->width);
+	*r = (int)(y * rows / config->height);
+	return *c < cols && *r < rows;
+}
+
+void render_ascii(const struct SnapshotFrame* f, const struct SimConfig* config, const struct Area* areas, FILE* out) {
+	char grid[RENDER_ROWS][RENDER_COLS + 2];
+	int c, r;
+
+	for (r = 0; r < RENDER_ROWS; r++) {
+		memset(grid[r], ' ', RENDER_COLS);
+		grid[r][RENDER_COLS] = '\r';
+		grid[r][RENDER_COLS + 1] = '\n';
+	}
+
+	// reas, depois msseis e por cima interceptores
+	for (int a = 0; a < config->num_areas; a++) {
+		int c0, r0, c1, r1;
+
+		if (to_cell(areas[a].x, areas[a].y, config, RENDER_COLS, RENDER_ROWS, &c0, &r0)
+			&& to_cell(areas[a].x + areas[a].width, areas[a].y + areas[a].height, config, RENDER_COLS, RENDER_ROWS, &c1, &r1)) {
+			for (r = r0; r <= r1; r++) {
+				memset(&grid[r][c0], f->area_hit[a] ? 'X' : '#', (size_t)(c1 - c0 + 1));
+			}
+		}
+	}
+	for (int i = 0; i < f->missiles + f->interceptors; i++) {
+		if (to_cell(f->x[i], f->y[i], config, RENDER_COLS, RENDER_ROWS, &c, &r)) {
+			grid[r][c] = i < f->missiles ? '*' : '+';
+		}
+	}
+
+	// Escreve a grade de uma vez
+	fwrite(grid, 1, sizeof(grid), out);
+	fprintf(out, "t = %.2f s  msseis %d  interceptores %d  acertos %u  interceptaes %u\r\n",
+		f->time, f->missiles, f->interceptors, f->hits, f->intercepts);
+}
+
+// Funo que pinta um retngulo da imagem, recortado pela janela
+static void fill_rect(uint8_t* pixels, int width, int height, int x0, int y0, int x1, int y1, const uint8_t* rgb) {
+	x0 = x0 < 0 ? 0 : x0;
+	y0 = y0 < 0 ? 0 : y0;
+	x1 = x1 >= width ? width - 1 : x1;
+	y1 = y1 >= height ? height - 1 : y1;
+
+	for (int y = y0; y <= y1; y++) {
+		uint8_t* p = pixels + ((size_t)y * width + x0) * 3;
+		for (int x = x0; x <= x1; x++, p += 3) {
+			p[0] = rgb[0];
+			p[1] = rgb[1];
+			p[2] = rgb[2];
+		}
+	}
+}
+
+int render_ppm(const struct SnapshotFrame* f, const struct SimConfig* config, const struct Area* areas, uint8_t* pixels, FILE* out) {
+	static const uint8_t area_color[3] = { 90, 90, 90 };
+	static const uint8_t hit_color[3] = { 200, 120, 0 };
+	static const uint8_t missile_color[3] = { 255, 40, 40 };
+	static const uint8_t interceptor_color[3] = { 40, 220, 40 };
+	int width = (int)config->width;
+	int height = (int)config->height;
+
+	memset(pixels, 0, RENDER_PPM_BYTES(config));
+
+	for (int a = 0; a < config->num_areas; a++) {
+		fill_rect(pixels, width, height, (int)areas[a].x, (int)areas[a].y, (int)(areas[a].x + areas[a].width),
+			(int)(areas[a].y + areas[a].height), f->area_hit[a] ? hit_color : area_color);
+	}
+
+	// Cada entidade vira um quadrado de 3x3 pixels
+	for (int i = 0; i < f->missiles + f->interceptors; i++) {
+		int x = (int)f->x[i];
+		int y = (int)f->y[i];
+		fill_rect(pixels, width, height, x - 1, y - 1, x + 1, y + 1, i < f->missiles ? missile_color : interceptor_color);
+	}
+
+	fprintf(out, "P6\n%d %d\n255\n", width, height);
+	return fwrite(pixels, 1, RENDER_PPM_BYTES(config), out) == RENDER_PPM_BYTES(config) ? 0 : -1;
+}
@@ -0,0 +1,26 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "simulation.h"
+#include "snapshot.h"
+
+// Desenho de quadros publicados pelo snapshot.h, fora das tarefas de tempo real
+
+#define RENDER_COLS 80 // Colunas da grade ASCII
+#define RENDER_ROWS 24 // Linhas da grade ASCII
+
+// Nmero de bytes da imagem de render_ppm para uma configurao (RGB, um pixel por unidade)
+#define RENDER_PPM_BYTES(config) ((size_t)(config)->width * (size_t)(config)->height * 3)
+
+// Desenha o quadro numa grade de RENDER_COLS x RENDER_ROWS caracteres: '#' rea, 'X' rea atingida,
+// '*' mssil e '+' interceptor, seguida de uma linha com o tempo e os contadores
+void render_ascii(const struct SnapshotFrame* f, const struct SimConfig* config, const struct Area* areas, FILE* out);
+
+// Grava o quadro como imagem PPM binria do tamanho da janela, usando pixels
+// (RENDER_PPM_BYTES bytes) como memria de trabalho. Retorna 0 se conseguiu.
+int render_ppm(const struct SnapshotFrame* f, const struct SimConfig* config, const struct Area* areas, uint8_t* pixels, FILE* out);
+
+#endif
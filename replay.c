@@ -0,0 +1,273 @@
+#include <string.h>
+
+#include "recorder.h"
+#include "replay.h"
+
+// Funes que leem inteiros em little-endian
+static uint32_t get_u16(const uint8_t* p) {
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static float get_f32(const uint8_t* p) {
+	uint32_t bits = get_u32(p);
+	float v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+static double get_f64(const uint8_t* p) {
+	uint64_t bits = (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+	double v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+// Funo que l um varint sem passar de end
+static uint32_t get_varint(const uint8_t** p, const uint8_t* end) {
+	uint32_t v = 0;
+	int shift = 0;
+
+	while (*p < end && shift < 32) {
+		uint8_t b = *(*p)++;
+		v |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) {
+			break;
+		}
+		shift += 7;
+	}
+	return v;
+}
+
+// Funo que l um inteiro com sinal em zigzag
+static int32_t get_svarint(const uint8_t** p, const uint8_t* end) {
+	uint32_t v = get_varint(p, end);
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Funo que percorre os cabealhos dos quadros completos a partir de frames_offset. Conta os
+// quadros-chave e, se keys no for NULL, preenche o ndice.
+static int scan_frames(struct Replay* r, struct ReplayKey* keys) {
+	const uint8_t* data = r->file.data;
+	size_t offset = r->frames_offset;
+	int num_keys = 0;
+
+	r->num_frames = 0;
+	while (offset + RECORDER_FRAME_HEADER_BYTES <= r->file.size) {
+		size_t length = get_u32(data + offset + 13);
+
+		if (length > r->file.size - offset - RECORDER_FRAME_HEADER_BYTES) {
+			break;
+		}
+		if (data[offset] == RECORDER_FRAME_KEY) {
+			if (keys != NULL) {
+				keys[num_keys].tick = get_u32(data + offset + 1);
+				keys[num_keys].offset = offset;
+			}
+			num_keys++;
+		}
+		r->last_tick = get_u32(data + offset + 1);
+		r->num_frames++;
+		offset += RECORDER_FRAME_HEADER_BYTES + length;
+	}
+
+	r->end = offset;
+	return num_keys;
+}
+
+int replay_open(struct Replay* r, const char* path) {
+	struct SimConfig config;
+	const uint8_t* h;
+	size_t m, i, bytes;
+	int areas;
+
+	r->memory = NULL;
+	if (host_map_file(&r->file, path) != 0) {
+		return -1;
+	}
+
+	// Cabealho do arquivo
+	h = r->file.data;
+	if (r->file.size < RECORDER_HEADER_BYTES(0) || memcmp(h, "MREC", 4) != 0 || get_u16(h + 4) != RECORDER_VERSION
+		|| get_u16(h + 6) == 0) {
+		replay_close(r);
+		return -1;
+	}
+	areas = (int)get_u32(h + 32);
+	if (areas <= 0 || areas > MAX_AREAS || r->file.size < RECORDER_HEADER_BYTES(areas)) {
+		replay_close(r);
+		return -1;
+	}
+	r->quantum = (int)get_u16(h + 6);
+	r->dt = get_f32(h + 8);
+	r->frames_offset = RECORDER_HEADER_BYTES(areas);
+
+	// A simulao reconstruda tem as mesmas capacidades e a mesma janela da gravada
+	sim_default_config(&config);
+	config.width = get_f32(h + 12);
+	config.height = get_f32(h + 16);
+	config.max_missiles = (int)get_u32(h + 24);
+	config.max_interceptors = (int)get_u32(h + 28);
+	config.num_areas = areas;
+
+	r->num_keys = scan_frames(r, NULL);
+	if (r->num_keys == 0) {
+		replay_close(r);
+		return -1;
+	}
+
+	m = ENTITY_ROUND_CAPACITY(config.max_missiles);
+	i = ENTITY_ROUND_CAPACITY(config.max_interceptors);
+	bytes = sim_arena_bytes(&config)
+		+ ARENA_BYTES(r->num_keys * sizeof(struct ReplayKey), sizeof(size_t))
+		+ 2 * ARENA_BYTES((m + i) * sizeof(int32_t), sizeof(int32_t));
+	r->memory = host_aligned_alloc(ENTITY_ALIGN, bytes);
+	if (r->memory == NULL) {
+		replay_close(r);
+		return -1;
+	}
+	arena_init(&r->arena, r->memory, bytes);
+
+	if (sim_create(&r->sim, &config, &r->arena) != 0) {
+		replay_close(r);
+		return -1;
+	}
+	r->keys = arena_alloc(&r->arena, r->num_keys * sizeof(struct ReplayKey), sizeof(size_t));
+	r->qx = arena_alloc(&r->arena, (m + i) * sizeof(int32_t), sizeof(int32_t));
+	r->qy = arena_alloc(&r->arena, (m + i) * sizeof(int32_t), sizeof(int32_t));
+	if (r->keys == NULL || r->qx == NULL || r->qy == NULL) {
+		replay_close(r);
+		return -1;
+	}
+	scan_frames(r, r->keys);
+	r->first_tick = r->keys[0].tick;
+
+	// Comea sem nenhum quadro reconstrudo, com as reas da gravao
+	init(&r->sim);
+	for (int a = 0; a < areas; a++) {
+		const uint8_t* p = h + RECORDER_HEADER_BYTES(a);
+		r->sim.areas[a].x = get_f32(p);
+		r->sim.areas[a].y = get_f32(p + 4);
+		r->sim.areas[a].width = get_f32(p + 8);
+		r->sim.areas[a].height = get_f32(p + 12);
+		r->sim.areas[a].value = r->sim.areas[a].width * r->sim.areas[a].height / AREA_VALUE_UNIT;
+	}
+	area_index_build(&r->sim.area_index, r->sim.areas, areas, config.width, config.height);
+	r->tick = -1;
+	r->next = r->frames_offset;
+	return 0;
+}
+
+void replay_close(struct Replay* r) {
+	host_aligned_free(r->memory);
+	r->memory = NULL;
+	host_unmap_file(&r->file);
+}
+
+// Funo que decodifica os registros de um armazenamento. base  a posio do armazenamento nos
+// vetores de posies quantizadas.
+static const uint8_t* decode_store(struct Replay* r, struct EntityStore* s, int base, const uint8_t* p, const uint8_t* end) {
+	uint32_t count = get_varint(&p, end);
+	float scale = 1.0f / r->quantum;
+	int i = -1;
+
+	memset(s->active, 0, (size_t)(s->capacity / ENTITY_MASK_BITS) * sizeof(uint32_t));
+	for (uint32_t n = 0; n < count && p < end; n++) {
+		uint32_t record = get_varint(&p, end);
+		int k;
+
+		i += 1 + (int)(record >> 1);
+		if (i >= s->capacity) {
+			break;
+		}
+		k = base + i;
+
+		if (record & 1) {
+			// Entidade nova: gerao e posio absoluta
+			s->generation[i] = *p++;
+			r->qx[k] = get_svarint(&p, end);
+			r->qy[k] = get_svarint(&p, end);
+		}
+		else {
+			r->qx[k] += get_svarint(&p, end);
+			r->qy[k] += get_svarint(&p, end);
+		}
+		s->x[i] = real_from_float(r->qx[k] * scale);
+		s->y[i] = real_from_float(r->qy[k] * scale);
+		entities_set_active(s, i, 1);
+	}
+	return p;
+}
+
+// Funo que aplica o quadro que comea em offset ao estado reconstrudo e retorna a posio do prximo
+static size_t apply_frame(struct Replay* r, size_t offset) {
+	struct Simulation* sim = &r->sim;
+	const uint8_t* frame = r->file.data + offset;
+	const uint8_t* p = frame + RECORDER_FRAME_HEADER_BYTES;
+	const uint8_t* end = p + get_u32(frame + 13);
+
+	sim->time = get_f64(frame + 5);
+	// A reproduo tem uma nica thread, ento os contadores gravados vo todos para uma cpia
+	stats_reset(&sim->counters);
+	stats_add(&sim->counters, STATS_MONITOR, STATS_MISSILES, get_varint(&p, end));
+	stats_add(&sim->counters, STATS_MONITOR, STATS_INTERCEPTORS, get_varint(&p, end));
+	stats_add(&sim->counters, STATS_MONITOR, STATS_HITS, get_varint(&p, end));
+	stats_add(&sim->counters, STATS_MONITOR, STATS_INTERCEPTS, get_varint(&p, end));
+	for (int a = 0; a < sim->config.num_areas && p + a / 8 < end; a++) {
+		sim->areas[a].hit = (p[a / 8] >> (a % 8)) & 1;
+	}
+	p += (sim->config.num_areas + 7) / 8;
+
+	p = decode_store(r, &sim->missiles, 0, p, end);
+	decode_store(r, &sim->interceptors, sim->missiles.capacity, p, end);
+
+	r->tick = get_u32(frame + 1);
+	return (size_t)(end - r->file.data);
+}
+
+int64_t replay_seek(struct Replay* r, int64_t tick) {
+	size_t offset;
+	int lo = 0, hi = r->num_keys - 1;
+
+	if (tick < r->first_tick) {
+		return -1;
+	}
+
+	// ltimo quadro-chave at tick (busca binria no ndice)
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (r->keys[mid].tick <= tick) {
+			lo = mid;
+		}
+		else {
+			hi = mid - 1;
+		}
+	}
+
+	// Continua do quadro atual se ele estiver entre o quadro-chave e o destino; seno recomea
+	// do quadro-chave ( assim que a reproduo recua)
+	if (r->tick >= r->keys[lo].tick && r->tick <= tick) {
+		offset = r->next;
+	}
+	else {
+		offset = r->keys[lo].offset;
+	}
+
+	while (offset < r->end && get_u32(r->file.data + offset + 1) <= tick) {
+		offset = apply_frame(r, offset);
+	}
+	r->next = offset;
+
+	// Mantm a grade coerente com as posies, para quem consulta a simulao reconstruda
+	grid_sync(&r->sim.missile_grid, &r->sim.missiles);
+	return r->tick;
+}
+
+int64_t replay_step(struct Replay* r, int64_t steps) {
+	int64_t tick = (r->tick >= 0 ? r->tick : (int64_t)r->first_tick) + steps;
+
+	return replay_seek(r, tick > r->first_tick ? tick : r->first_tick);
+}
@@ -0,0 +1,60 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "host.h"
+#include "simulation.h"
+
+// Reproduo de uma gravao feita pelo recorder.h, sem executar a simulao. O arquivo  mapeado
+// em memria e indexado pelos quadros-chave na abertura; qualquer passo  reconstrudo a partir do
+// quadro-chave anterior mais prximo, aplicando no mximo RECORDER_KEYFRAME_INTERVAL deltas. O
+// estado vai para uma struct Simulation comum, ento quem desenha ou calcula estatsticas sobre
+// uma simulao ao vivo funciona igual sobre a reproduo (s as posies e os contadores so
+// gravados: velocidades, ngulos e a lista de livres no so reconstrudos).
+
+// Quadro-chave no ndice da gravao
+struct ReplayKey {
+	uint32_t tick; // Passo do quadro
+	size_t offset; // Posio do quadro no arquivo
+};
+
+// Reproduo de uma gravao
+struct Replay {
+	struct HostMapping file; // Arquivo mapeado
+	struct Simulation sim; // Estado reconstrudo do passo atual
+	float dt; // Passo fixo da gravao em segundos
+	int quantum; // Fraes de unidade por passo de quantizao das posies
+	size_t frames_offset; // Posio do primeiro quadro
+	size_t end; // Fim do ltimo quadro completo (uma gravao interrompida pode terminar no meio de um)
+	int num_frames; // Nmero de quadros completos
+	struct ReplayKey* keys; // ndice dos quadros-chave, em ordem de passo
+	int num_keys; // Nmero de quadros-chave
+	uint32_t first_tick; // Passo do primeiro quadro-chave
+	uint32_t last_tick; // Passo do ltimo quadro completo
+	int64_t tick; // Passo do quadro reconstrudo, ou -1 se nenhum
+	size_t next; // Posio do quadro seguinte ao reconstrudo
+	int32_t* qx; // Posies x quantizadas do quadro reconstrudo (msseis e depois interceptores)
+	int32_t* qy; // Posies y quantizadas do quadro reconstrudo
+	struct Arena arena; // Arena com a simulao, o ndice e as posies quantizadas
+	void* memory; // Regio da arena
+};
+
+// Mapeia e indexa uma gravao. Retorna 0 em caso de sucesso, ou -1 se o arquivo no puder ser
+// lido, no for uma gravao desta verso ou no tiver nenhum quadro-chave completo.
+int replay_open(struct Replay* r, const char* path);
+
+// Libera a memria e desfaz o mapeamento
+void replay_close(struct Replay* r);
+
+// Reconstri o ltimo quadro gravado at o passo tick (inclusive). Avana a partir do quadro atual
+// quando no h quadro-chave mais prximo. Retorna o passo reconstrudo, ou -1 se tick for anterior
+// ao primeiro quadro-chave.
+int64_t replay_seek(struct Replay* r, int64_t tick);
+
+// Avana steps passos a partir do atual, ou recua se steps for negativo
+int64_t replay_step(struct Replay* r, int64_t steps);
+
+#endif
@@ -0,0 +1,51 @@
+#include <string.h>
+
+#include "ring.h"
+
+void spsc_init(struct SpscRing* r, unsigned int capacity, size_t size, void* buffer) {
+	atomic_init(&r->head, 0);
+	atomic_init(&r->tail, 0);
+	r->cached_tail = 0;
+	r->cached_head = 0;
+	r->mask = capacity - 1;
+	r->size = size;
+	r->buffer = (uint8_t*)buffer;
+}
+
+// Funo executada apenas pelo produtor
+int spsc_push(struct SpscRing* r, const void* elem) {
+	unsigned int head = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+	// S rel o ndice do consumidor quando a cpia local indica que o anel est cheio
+	if (head - r->cached_tail > r->mask) {
+		r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+		if (head - r->cached_tail > r->mask) {
+			return 0;
+		}
+	}
+
+	memcpy(r->buffer + (size_t)(head & r->mask) * r->size, elem, r->size);
+
+	// Publica o elemento: o consumidor que ler o novo head enxerga o contedo copiado
+	atomic_store_explicit(&r->head, head + 1, memory_order_release);
+	return 1;
+}
+
+// Funo executada apenas pelo consumidor
+int spsc_pop(struct SpscRing* r, void* elem) {
+	unsigned int tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+
+	// S rel o ndice do produtor quando a cpia local indica que o anel est vazio
+	if (tail == r->cached_head) {
+		r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+		if (tail == r->cached_head) {
+			return 0;
+		}
+	}
+
+	memcpy(elem, r->buffer + (size_t)(tail & r->mask) * r->size, r->size);
+
+	// Libera a posio para o produtor s depois de copiar o elemento
+	atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+	return 1;
+}
@@ -0,0 +1,37 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Tamanho de uma linha de cache, usado para separar os ndices do produtor e do consumidor
+#define RING_CACHE_LINE 64
+
+// Nmero de bytes do buffer de um anel com capacity elementos de size bytes
+#define SPSC_RING_BYTES(capacity, size) ((size_t)(capacity) * (size))
+
+// Anel sem travas para um nico produtor e um nico consumidor.
+// O produtor s escreve head e o consumidor s escreve tail; cada lado guarda uma cpia
+// do ndice do outro para no disputar a linha de cache a cada operao.
+struct SpscRing {
+	_Alignas(RING_CACHE_LINE) atomic_uint head; // Prxima posio de escrita
+	unsigned int cached_tail; // ltima posio de leitura vista pelo produtor
+	_Alignas(RING_CACHE_LINE) atomic_uint tail; // Prxima posio de leitura
+	unsigned int cached_head; // ltima posio de escrita vista pelo consumidor
+	_Alignas(RING_CACHE_LINE) unsigned int mask; // Capacidade - 1 (a capacidade  potncia de 2)
+	size_t size; // Tamanho de cada elemento em bytes
+	uint8_t* buffer; // Elementos
+};
+
+// Inicializa um anel vazio sobre um buffer de SPSC_RING_BYTES(capacity, size) bytes.
+// A capacidade precisa ser uma potncia de 2.
+void spsc_init(struct SpscRing* r, unsigned int capacity, size_t size, void* buffer);
+
+// Copia um elemento para o anel. Retorna 0 se o anel estiver cheio.
+int spsc_push(struct SpscRing* r, const void* elem);
+
+// Copia o elemento mais antigo para elem e o retira do anel. Retorna 0 se o anel estiver vazio.
+int spsc_pop(struct SpscRing* r, void* elem);
+
+#endif
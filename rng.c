@@ -0,0 +1,72 @@
+#include "real.h"
+#include "rng.h"
+
+// Nmero de bits de cada sorteio em float (a mantissa de um float tem 24 bits)
+#define RNG_FLOAT_BITS 24
+
+uint64_t rng_mix(uint64_t seed, uint64_t i) {
+	uint64_t z = seed + (i + 1) * 0x9E3779B97F4A7C15ull;
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+void rng_seed(struct Rng* r, uint64_t seed, uint64_t stream) {
+	// Mistura a semente com o fluxo e expande o resultado pelo splitmix64, como recomendado pelos
+	// autores do xoshiro. O splitmix64  uma bijeo, ento o estado nunca fica todo zero.
+	uint64_t base = rng_mix(seed, rng_mix(stream, 0));
+
+	for (int k = 0; k < 4; k++) {
+		r->s[k] = rng_mix(base, (uint64_t)k);
+	}
+}
+
+uint32_t rng_below(struct Rng* r, uint32_t n) {
+	// Multiplicao de Lemire: os 32 bits altos de x * n so uniformes em [0, n) depois de
+	// rejeitar a pequena faixa que daria vis
+	uint64_t m = (rng_next(r) >> 32) * n;
+	uint32_t low = (uint32_t)m;
+
+	if (low < n) {
+		uint32_t threshold = (uint32_t)(-n) % n;
+
+		while (low < threshold) {
+			m = (rng_next(r) >> 32) * n;
+			low = (uint32_t)m;
+		}
+	}
+
+	return (uint32_t)(m >> 32);
+}
+
+// Funo que converte 24 bits aleatrios num nmero em [min, max)
+static float scale(uint32_t bits, float min, float max) {
+#if SIM_FIXED_POINT
+	// Em ponto fixo a escala  feita com inteiros, para que a sequncia seja a mesma em qualquer mquina
+	fixed_t low = fx_from_double(min);
+	return (float)fx_to_double(low + (fixed_t)(((int64_t)(fx_from_double(max) - low) * bits) >> RNG_FLOAT_BITS));
+#else
+	return min + (max - min) * ((float)bits * (1.0f / (1 << RNG_FLOAT_BITS)));
+#endif
+}
+
+float rng_float(struct Rng* r, float min, float max) {
+	return scale((uint32_t)(rng_next(r) >> (64 - RNG_FLOAT_BITS)), min, max);
+}
+
+void rng_floats(struct Rng* r, float* out, int n, float min, float max) {
+	int i = 0;
+
+	// Os 24 bits mais altos e os 24 seguintes de cada nmero do dois sorteios independentes
+	for (; i + 1 < n; i += 2) {
+		uint64_t x = rng_next(r);
+
+		out[i] = scale((uint32_t)(x >> (64 - RNG_FLOAT_BITS)), min, max);
+		out[i + 1] = scale((uint32_t)(x >> (64 - 2 * RNG_FLOAT_BITS)) & ((1u << RNG_FLOAT_BITS) - 1), min, max);
+	}
+
+	if (i < n) {
+		out[i] = rng_float(r, min, max);
+	}
+}
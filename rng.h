@@ -0,0 +1,49 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Gerador pseudoaleatrio xoshiro256** com estado explcito. Cada tarefa ou cenrio tem o seu
+// prprio fluxo, ento a sequncia de um no depende de quando os outros sorteiam, e nenhum
+// estado  compartilhado entre threads. Com SIM_FIXED_POINT (real.h) a converso para float 
+// feita com inteiros, e a sequncia de floats  a mesma em qualquer mquina.
+
+// Estado de um fluxo (no pode ser todo zero; rng_seed garante isso)
+struct Rng {
+	uint64_t s[4];
+};
+
+// Inicializa o fluxo stream da semente seed. Fluxos diferentes de uma mesma semente so independentes.
+void rng_seed(struct Rng* r, uint64_t seed, uint64_t stream);
+
+// Mistura dois valores de 64 bits num s (finalizador do splitmix64), para derivar sementes
+uint64_t rng_mix(uint64_t seed, uint64_t i);
+
+// Gera o prximo nmero de 64 bits
+static inline uint64_t rng_next(struct Rng* r) {
+	uint64_t* s = r->s;
+	uint64_t x = s[1] * 5;
+	uint64_t result = ((x << 7) | (x >> 57)) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 45) | (s[3] >> 19);
+
+	return result;
+}
+
+// Gera um inteiro uniforme em [0, n), sem vis (n > 0)
+uint32_t rng_below(struct Rng* r, uint32_t n);
+
+// Gera um nmero uniforme entre min e max
+float rng_float(struct Rng* r, float min, float max);
+
+// Preenche out com n nmeros uniformes entre min e max, dois por nmero de 64 bits gerado.
+// Usado para sortear os parmetros de uma onda de ataque inteira de uma vez.
+void rng_floats(struct Rng* r, float* out, int n, float min, float max);
+
+#endif
@@ -0,0 +1,174 @@
+#include <string.h>
+
+#include "host.h"
+#include "rtmon.h"
+
+void rtmon_init(struct RtTask* t, const char* name, uint64_t period, uint64_t deadline, int kind) {
+	memset(&t->job, 0, sizeof(t->job));
+	memset(&t->last, 0, sizeof(t->last));
+	t->name = name;
+	t->period = period;
+	t->deadline = deadline;
+	t->kind = kind;
+	t->in_job = 0;
+	t->next_release = 0;
+	t->ready = 0;
+	t->run_start = 0;
+	t->prev_release = 0;
+	atomic_init(&t->sequence, 0);
+	atomic_init(&t->jobs, 0);
+	atomic_init(&t->misses, 0);
+	atomic_init(&t->wcet, 0);
+	atomic_init(&t->wcrt, 0);
+	atomic_init(&t->min_interval, 0);
+	hist_reset(&t->response);
+	hist_reset(&t->execution);
+}
+
+void rtmon_job_start(struct RtTask* t) {
+	uint64_t now = host_time_ns();
+
+	// A liberao vista pelo gancho  exata; a estimada pode passar do incio por arredondamento
+	// dos ticks, e no primeiro job no h estimativa
+	t->job.release = t->ready != 0 ? t->ready : t->next_release;
+	if (t->job.release == 0 || t->job.release > now) {
+		t->job.release = now;
+	}
+	t->job.start = now;
+	t->job.deadline = t->job.release + t->deadline;
+	t->job.exec = 0;
+	t->ready = 0;
+	t->run_start = now;
+	t->in_job = 1;
+
+	if (t->prev_release != 0) {
+		uint64_t interval = t->job.release - t->prev_release;
+		uint64_t min = atomic_load_explicit(&t->min_interval, memory_order_relaxed);
+
+		if (min == 0 || interval < min) {
+			atomic_store_explicit(&t->min_interval, interval, memory_order_relaxed);
+		}
+	}
+	t->prev_release = t->job.release;
+}
+
+void rtmon_job_finish(struct RtTask* t, uint64_t delay) {
+	uint64_t now = host_time_ns();
+	uint64_t response;
+	unsigned int sequence;
+
+	t->in_job = 0;
+	t->job.finish = now;
+	t->job.exec += now - t->run_start;
+	response = now - t->job.release;
+	// Numa tarefa espordica o prximo evento  desconhecido; sem gancho a liberao fica sendo
+	// o incio do job, nunca o fim deste, para que a espera pelo evento no conte como resposta
+	if (t->kind == RTMON_PERIODIC) {
+		t->next_release = t->job.release + t->period;
+	}
+	else {
+		t->next_release = t->kind == RTMON_SPORADIC ? 0 : now + delay;
+	}
+
+	// Publica o job pelo seqlock (a tarefa  o nico escritor)
+	sequence = atomic_load_explicit(&t->sequence, memory_order_relaxed);
+	atomic_store_explicit(&t->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	t->last = t->job;
+	atomic_store_explicit(&t->sequence, sequence + 2, memory_order_release);
+
+	if (now > t->job.deadline) {
+		atomic_store_explicit(&t->misses, atomic_load_explicit(&t->misses, memory_order_relaxed) + 1, memory_order_relaxed);
+	}
+	if (t->job.exec > atomic_load_explicit(&t->wcet, memory_order_relaxed)) {
+		atomic_store_explicit(&t->wcet, t->job.exec, memory_order_relaxed);
+	}
+	if (response > atomic_load_explicit(&t->wcrt, memory_order_relaxed)) {
+		atomic_store_explicit(&t->wcrt, response, memory_order_relaxed);
+	}
+	hist_record(&t->response, response);
+	hist_record(&t->execution, t->job.exec);
+	atomic_store_explicit(&t->jobs, atomic_load_explicit(&t->jobs, memory_order_relaxed) + 1, memory_order_release);
+}
+
+// Os ganchos rodam no escalonador, com a tarefa parada, ento no disputam os campos com ela
+
+void rtmon_ready(void* tag) {
+	struct RtTask* t = tag;
+
+	// S a primeira vez que a tarefa fica pronta entre dois jobs  uma liberao; durante o job
+	// ela pode bloquear e voltar (ring_send com o anel cheio)
+	if (t != NULL && !t->in_job && t->ready == 0) {
+		t->ready = host_time_ns();
+	}
+}
+
+void rtmon_switched_in(void* tag) {
+	struct RtTask* t = tag;
+
+	if (t != NULL && t->in_job) {
+		t->run_start = host_time_ns();
+	}
+}
+
+void rtmon_switched_out(void* tag) {
+	struct RtTask* t = tag;
+
+	if (t != NULL && t->in_job) {
+		t->job.exec += host_time_ns() - t->run_start;
+	}
+}
+
+void rtmon_read(const struct RtTask* t, struct RtTaskStats* out) {
+	out->name = t->name;
+	out->period = t->period;
+	out->deadline = t->deadline;
+	out->jobs = atomic_load_explicit(&t->jobs, memory_order_acquire);
+	out->misses = atomic_load_explicit(&t->misses, memory_order_relaxed);
+	out->wcet = atomic_load_explicit(&t->wcet, memory_order_relaxed);
+	out->wcrt = atomic_load_explicit(&t->wcrt, memory_order_relaxed);
+	out->min_interval = atomic_load_explicit(&t->min_interval, memory_order_relaxed);
+	out->has_last = 0;
+
+	for (int attempt = 0; attempt < RTMON_READ_RETRIES && out->jobs > 0; attempt++) {
+		unsigned int before = atomic_load_explicit(&t->sequence, memory_order_acquire);
+
+		if (before & 1) {
+			continue;
+		}
+		out->last = t->last;
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&t->sequence, memory_order_relaxed) == before) {
+			out->has_last = 1;
+			break;
+		}
+	}
+}
+
+void rtmon_print(const struct RtTask* t, FILE* out) {
+	struct RtTaskStats s;
+	char name[32];
+
+	rtmon_read(t, &s);
+	fprintf(out, "%-8s jobs %-8u perdas de prazo %-6u prazo %10.1f  WCET %10.1f  pior resposta %10.1f us\n",
+		s.name, s.jobs, s.misses, s.deadline / 1000.0, s.wcet / 1000.0, s.wcrt / 1000.0);
+	if (s.has_last) {
+		fprintf(out, "%-8s ltimo job: incio +%.1f  fim +%.1f  folga %.1f us\n", "",
+			(s.last.start - s.last.release) / 1000.0, (s.last.finish - s.last.release) / 1000.0,
+			((double)s.last.deadline - (double)s.last.finish) / 1000.0);
+	}
+	snprintf(name, sizeof(name), "%s resposta", s.name);
+	hist_print(&t->response, name, out);
+	snprintf(name, sizeof(name), "%s execuo", s.name);
+	hist_print(&t->execution, name, out);
+}
+
+void rtmon_write(const struct RtTask* t, FILE* out) {
+	struct RtTaskStats s;
+	uint64_t interval;
+
+	rtmon_read(t, &s);
+	interval = t->kind == RTMON_PERIODIC || s.min_interval == 0 ? s.period : s.min_interval;
+	fprintf(out, "%s %.1f %.1f %.1f %s\n", s.name, interval / 1000.0, s.deadline / 1000.0, s.wcet / 1000.0,
+		t->kind == RTMON_PERIODIC ? "periodica" : (t->kind == RTMON_SPORADIC ? "esporadica" : "atraso"));
+}
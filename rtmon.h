@@ -0,0 +1,115 @@
+#ifndef RTMON_H
+#define RTMON_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "stats.h"
+
+// Instrumentao de tempo real das tarefas: para cada job (uma ativao da tarefa) registra a
+// liberao, o incio, o fim e o prazo absoluto, e acumula o pior tempo de execuo (WCET)
+// observado, o pior tempo de resposta, as perdas de prazo e histogramas de ambos. Os tempos vm
+// de host_time_ns(), em nanossegundos.
+//
+// Sem ajuda do escalonador a liberao  estimada (a anterior mais o perodo, ou o fim do job
+// anterior mais a espera) e o tempo de execuo inclui as preempes. Com os ganchos de trace do
+// FreeRTOS a liberao  o instante em que a tarefa fica pronta e as preempes so descontadas.
+// Para isso o FreeRTOSConfig.h deve ter configUSE_APPLICATION_TASK_TAG 1 e
+//
+//   void rtmon_ready(void* tag);
+//   void rtmon_switched_in(void* tag);
+//   void rtmon_switched_out(void* tag);
+//   #define traceMOVED_TASK_TO_READY_STATE(pxTCB) rtmon_ready((void*)(pxTCB)->pxTaskTag)
+//   #define traceTASK_SWITCHED_IN() rtmon_switched_in((void*)pxCurrentTCB->pxTaskTag)
+//   #define traceTASK_SWITCHED_OUT() rtmon_switched_out((void*)pxCurrentTCB->pxTaskTag)
+//
+// e cada tarefa instrumentada deve ter como tag a sua struct RtTask (vTaskSetApplicationTaskTag).
+// Se o trace recorder j definir esses macros, as chamadas entram no fim das definies dele.
+
+#define RTMON_CACHE_LINE 64 // Tamanho de uma linha de cache
+#define RTMON_READ_RETRIES 4 // Tentativas de leitura do ltimo job antes de desistir
+
+// Como a tarefa  liberada, o que define a liberao estimada quando no h ganchos
+#define RTMON_DELAYED 0 // Espera depois de cada job (vTaskDelay): o fim do job anterior mais a espera
+#define RTMON_PERIODIC 1 // A cada perodo (vTaskDelayUntil): a liberao anterior mais o perodo
+#define RTMON_SPORADIC 2 // Por um evento, como uma notificao: o incio do job
+
+// Tempos absolutos de um job em nanossegundos
+struct RtJob {
+	uint64_t release; // Liberao (a tarefa ficou pronta)
+	uint64_t start; // Incio da execuo
+	uint64_t finish; // Fim da execuo
+	uint64_t deadline; // Prazo absoluto (liberao mais o prazo relativo)
+	uint64_t exec; // Tempo de execuo, sem as preempes se os ganchos esto ligados
+};
+
+struct RtTask {
+	const char* name; // Nome da tarefa
+	uint64_t period; // Perodo, ou intervalo entre jobs, em nanossegundos
+	uint64_t deadline; // Prazo relativo em nanossegundos
+	int kind; // Forma de liberao (RTMON_DELAYED, RTMON_PERIODIC ou RTMON_SPORADIC)
+
+	// Job atual, escrito pela tarefa e pelos ganchos do escalonador (nunca ao mesmo tempo)
+	int in_job; // Indica se um job est em execuo
+	uint64_t next_release; // Liberao estimada do prximo job, ou 0 se desconhecida
+	uint64_t ready; // Instante em que o gancho viu a tarefa ficar pronta, ou 0
+	uint64_t run_start; // Incio do trecho atual de execuo contnua
+	uint64_t prev_release; // Liberao do job anterior, ou 0
+	struct RtJob job; // Tempos do job atual
+
+	// Resultados, escritos s pela tarefa e lidos a qualquer momento por rtmon_read
+	_Alignas(RTMON_CACHE_LINE) atomic_uint sequence; // Seqlock do ltimo job (mpar durante a escrita)
+	struct RtJob last; // ltimo job concludo
+	atomic_uint jobs; // Jobs concludos
+	atomic_uint misses; // Jobs que terminaram depois do prazo
+	atomic_uint_least64_t wcet; // Maior tempo de execuo observado
+	atomic_uint_least64_t wcrt; // Maior tempo de resposta observado (da liberao ao fim)
+	atomic_uint_least64_t min_interval; // Menor intervalo observado entre duas liberaes, ou 0
+	struct Histogram response; // Tempos de resposta
+	struct Histogram execution; // Tempos de execuo
+};
+
+// Cpia dos resultados de uma tarefa
+struct RtTaskStats {
+	const char* name;
+	uint64_t period;
+	uint64_t deadline;
+	unsigned int jobs;
+	unsigned int misses;
+	uint64_t wcet;
+	uint64_t wcrt;
+	uint64_t min_interval;
+	int has_last; // Indica se last  vlido
+	struct RtJob last;
+};
+
+// Prepara a instrumentao de uma tarefa com o seu perodo (nas espordicas, o intervalo mnimo
+// esperado entre liberaes), o prazo relativo em nanossegundos e a forma de liberao
+void rtmon_init(struct RtTask* t, const char* name, uint64_t period, uint64_t deadline, int kind);
+
+// Marca o incio de um job. Chamada pela prpria tarefa ao acordar.
+void rtmon_job_start(struct RtTask* t);
+
+// Marca o fim do job atual e publica os seus tempos. delay  a espera em nanossegundos at o
+// prximo job das tarefas RTMON_DELAYED (ignorada nas outras).
+void rtmon_job_finish(struct RtTask* t, uint64_t delay);
+
+// Ganchos do escalonador; tag  a tag da tarefa, que s  usada se no for NULL
+void rtmon_ready(void* tag);
+void rtmon_switched_in(void* tag);
+void rtmon_switched_out(void* tag);
+
+// Copia os resultados de uma tarefa sem bloque-la
+void rtmon_read(const struct RtTask* t, struct RtTaskStats* out);
+
+// Imprime os resultados e os histogramas de uma tarefa
+void rtmon_print(const struct RtTask* t, FILE* out);
+
+// Escreve a tarefa como uma linha do conjunto de tarefas lido por tools/schedcheck.c:
+// nome, intervalo mnimo entre liberaes, prazo e WCET, em microssegundos, e a forma de
+// liberao (periodica, atraso ou esporadica). O intervalo  o perodo nas tarefas peridicas e
+// o menor observado nas outras (ou o perodo, se ainda no h).
+void rtmon_write(const struct RtTask* t, FILE* out);
+
+#endif
@@ -0,0 +1,491 @@
+#include <math.h>
+
+#include "ballistics.h"
+#include "fastmath.h"
+#include "simulation.h"
+
+// Fluxos dos geradores aleatrios de uma simulao, todos derivados de config.seed
+#define STREAM_AREAS 0 // reas sorteadas em init
+#define STREAM_ATTACK 1 // Ondas e intervalos de ataque
+
+void sim_default_config(struct SimConfig* config) {
+	config->missiles_per_wave = NUM_MISSILES;
+	config->interceptors_per_defense = NUM_INTERCEPTORS;
+	config->max_missiles = MAX_MISSILES;
+	config->max_interceptors = MAX_INTERCEPTORS;
+	config->num_areas = NUM_AREAS;
+	config->area_list = NULL;
+	config->num_launchers = NUM_LAUNCHERS;
+	config->ring_capacity = DESCRIPTOR_RING_CAPACITY;
+	config->width = WINDOW_WIDTH;
+	config->height = WINDOW_HEIGHT;
+	config->seed = SIM_DEFAULT_SEED;
+}
+
+// Funo que calcula o nmero de colunas e de linhas da grade de coliso de uma configurao
+static void grid_size(const struct SimConfig* config, int* cols, int* rows) {
+	*cols = (int)ceilf(config->width / GRID_CELL_SIZE);
+	*rows = (int)ceilf(config->height / GRID_CELL_SIZE);
+}
+
+size_t sim_arena_bytes(const struct SimConfig* config) {
+	int cols, rows;
+
+	grid_size(config, &cols, &rows);
+	return ARENA_BYTES(ENTITY_STORE_BYTES(config->max_missiles), ENTITY_ALIGN)
+		+ ARENA_BYTES(ENTITY_STORE_BYTES(config->max_interceptors), ENTITY_ALIGN)
+		+ ARENA_BYTES(GRID_BYTES(cols, rows, config->max_missiles), sizeof(int))
+		+ ARENA_BYTES(config->num_areas * sizeof(struct Area), sizeof(float))
+		+ area_index_arena_bytes(config->num_areas, config->width, config->height)
+		+ ARENA_BYTES(config->num_launchers * sizeof(struct Launcher), sizeof(float))
+		+ ARENA_BYTES(4 * (size_t)config->missiles_per_wave * sizeof(float), sizeof(float));
+}
+
+// Funo que reserva na arena toda a memria da simulao. Depois disso nenhum vetor 
+// alocado: init apenas reinicia o contedo.
+int sim_create(struct Simulation* sim, const struct SimConfig* config, struct Arena* arena) {
+	int cols, rows;
+
+	// Verifica se a configurao  vlida
+	if (config->missiles_per_wave <= 0 || config->interceptors_per_defense <= 0 || config->max_missiles <= 0
+		|| config->max_interceptors <= 0 || config->num_areas <= 0 || config->num_areas > MAX_AREAS
+		|| config->num_launchers <= 0 || config->num_launchers > MAX_LAUNCHERS
+		|| config->ring_capacity == 0 || (config->ring_capacity & (config->ring_capacity - 1)) != 0
+		|| config->ring_capacity < (unsigned int)config->missiles_per_wave
+		|| config->width <= 0 || config->height <= 0) {
+		return -1;
+	}
+
+#if SIM_FIXED_POINT
+	// Uma janela maior saturaria as bordas e faria as posies estourarem 32 bits na integrao
+	if (config->width > SIM_FIXED_MAX_EXTENT || config->height > SIM_FIXED_MAX_EXTENT) {
+		return -1;
+	}
+#endif
+
+	sim->config = *config;
+	grid_size(config, &cols, &rows);
+
+	sim->missile_storage = arena_alloc(arena, ENTITY_STORE_BYTES(config->max_missiles), ENTITY_ALIGN);
+	sim->interceptor_storage = arena_alloc(arena, ENTITY_STORE_BYTES(config->max_interceptors), ENTITY_ALIGN);
+	sim->missile_grid_storage = arena_alloc(arena, GRID_BYTES(cols, rows, config->max_missiles), sizeof(int));
+	sim->areas = arena_alloc(arena, config->num_areas * sizeof(struct Area), sizeof(float));
+	sim->launchers = arena_alloc(arena, config->num_launchers * sizeof(struct Launcher), sizeof(float));
+	sim->wave_scratch = arena_alloc(arena, 4 * (size_t)config->missiles_per_wave * sizeof(float), sizeof(float));
+
+	if (sim->missile_storage == NULL || sim->interceptor_storage == NULL || sim->missile_grid_storage == NULL
+		|| sim->areas == NULL || sim->launchers == NULL || sim->wave_scratch == NULL) {
+		return -1;
+	}
+	return area_index_create(&sim->area_index, config->num_areas, config->width, config->height, arena);
+}
+
+// Funo que inicializa o sistema
+void init(struct Simulation* sim) {
+	const struct SimConfig* config = &sim->config;
+	int cols, rows;
+
+	// Inicializa as variveis globais
+	stats_reset(&sim->counters);
+	sim->time = 0;
+	sim->next_impact = HUGE_VAL;
+	sim->missile_speed_bound = 0;
+	sim->next_missile_id = 0;
+	sim->next_interceptor_id = 0;
+	rng_seed(&sim->area_rng, config->seed, STREAM_AREAS);
+	rng_seed(&sim->attack_rng, config->seed, STREAM_ATTACK);
+
+	// Inicializa os msseis e os interceptores como inativos
+	entities_init(&sim->missiles, config->max_missiles, sim->missile_storage);
+	entities_init(&sim->interceptors, config->max_interceptors, sim->interceptor_storage);
+
+	// Inicializa a grade de coliso com clulas do tamanho da tolerncia de interceptao
+	grid_size(config, &cols, &rows);
+	grid_init(&sim->missile_grid, cols, rows, GRID_CELL_SIZE, config->max_missiles, sim->missile_grid_storage);
+
+	// Inicializa as reas habitadas com as lidas do arquivo ou com posies e tamanhos aleatrios
+	// (na janela padro, x e y ficam entre 100 e 200)
+	for (int i = 0; i < config->num_areas; i++) {
+		if (config->area_list != NULL) {
+			sim->areas[i] = config->area_list[i];
+		}
+		else {
+			sim->areas[i].x = rng_float(&sim->area_rng, config->width / 8, config->width / 4);
+			sim->areas[i].y = rng_float(&sim->area_rng, config->height / 6, config->height / 3);
+			sim->areas[i].width = rng_float(&sim->area_rng, 10, 50);
+			sim->areas[i].height = rng_float(&sim->area_rng, 10, 50);
+		}
+		sim->areas[i].hit = 0;
+		sim->areas[i].value = sim->areas[i].width * sim->areas[i].height / AREA_VALUE_UNIT;
+	}
+	area_index_build(&sim->area_index, sim->areas, config->num_areas, config->width, config->height);
+
+	// Distribui os lanadores pela borda inferior, a partir do canto inferior direito
+	for (int i = 0; i < config->num_launchers; i++) {
+		sim->launchers[i].x = config->width * (config->num_launchers - i) / config->num_launchers;
+		sim->launchers[i].y = config->height;
+	}
+}
+
+// Funo que gera uma onda de ataque (corpo da tarefa de ataque). Os msseis no so colocados
+// na simulao aqui: quem chama entrega os descritores ao monitor e  defesa.
+int attack_wave(struct Simulation* sim, double now, struct LaunchDescriptor* wave) {
+	// Gera um nmero aleatrio de msseis a serem disparados entre 1 e missiles_per_wave
+	int m = sim->config.missiles_per_wave;
+	int n = 1 + (int)rng_below(&sim->attack_rng, (uint32_t)m);
+	float* angle = sim->wave_scratch;
+	float* speed = angle + m;
+	float* vx = speed + m;
+	float* vy = vx + m;
+
+	// Sorteia os parmetros dos msseis (ngulo em graus e velocidade em unidades/s) da onda inteira
+	rng_floats(&sim->attack_rng, angle, n, 10, 80);
+	rng_floats(&sim->attack_rng, speed, n, 100, 200);
+
+	// Converte a onda inteira em componentes de velocidade de uma vez. Como y cresce para baixo,
+	// a componente y  negada para que os msseis subam a partir do canto inferior esquerdo
+	fm_polar_deg_batch(angle, speed, vx, vy, n, 1.0f, -1.0f);
+
+	// Descreve os msseis
+	for (int i = 0; i < n; i++) {
+		describe_missile(sim, &wave[i], now, 0, sim->config.height, angle[i], speed[i], vx[i], vy[i]);
+	}
+
+	// Atualiza o nmero de msseis disparados
+	stats_add(&sim->counters, STATS_ATTACK, STATS_MISSILES, (unsigned int)n);
+
+	return n;
+}
+
+// Funo que atualiza o estado do sistema
+void update(struct Simulation* sim, float dt) {
+	// Atualiza a posio e a velocidade de todos os msseis e interceptores ativos de uma vez,
+	// desativando os que saram da janela grfica
+	entities_integrate(&sim->missiles, GRAVITY, dt, sim->config.width, sim->config.height);
+	entities_integrate(&sim->interceptors, GRAVITY, dt, sim->config.width, sim->config.height);
+	sim->time += dt;
+
+	// O impacto de cada mssil j foi previsto no lanamento, ento os msseis s so percorridos
+	// quando o instante do prximo impacto chega
+	if (sim->time >= sim->next_impact) {
+		sim->next_impact = HUGE_VAL;
+
+		for (int i = entities_next_active(&sim->missiles, 0); i >= 0; i = entities_next_active(&sim->missiles, i + 1)) {
+			int j = sim->missiles.impact_area[i];
+
+			if (j < 0) {
+				continue;
+			}
+
+			if (sim->time >= sim->missiles.impact_time[i]) {
+				// Marca a rea como atingida
+				sim->areas[j].hit = 1;
+
+				// Atualiza o nmero de msseis que atingiram as reas
+				stats_add(&sim->counters, STATS_MONITOR, STATS_HITS, 1);
+
+				// Desativa o mssil e devolve o seu ndice
+				entities_release(&sim->missiles, i);
+			}
+			else if (sim->missiles.impact_time[i] < sim->next_impact) {
+				sim->next_impact = sim->missiles.impact_time[i];
+			}
+		}
+	}
+
+	// Atualiza a grade apenas com os msseis que mudaram de clula ou foram desativados
+	grid_sync(&sim->missile_grid, &sim->missiles);
+
+	// Percorre apenas os interceptores que continuam ativos
+	for (int i = entities_next_active(&sim->interceptors, 0); i >= 0; i = entities_next_active(&sim->interceptors, i + 1)) {
+		// Procura o mssil interceptado em algum instante do passo, nas clulas ao alcance
+		int j = find_intercepted(sim, sim->interceptors.x[i], sim->interceptors.y[i], sim->interceptors.vx[i], sim->interceptors.vy[i], dt);
+
+		if (j >= 0) {
+			// Atualiza o nmero de msseis que foram interceptados
+			stats_add(&sim->counters, STATS_MONITOR, STATS_INTERCEPTS, 1);
+
+			// Desativa o mssil e o interceptor e devolve os seus ndices
+			entities_release(&sim->missiles, j);
+			grid_remove(&sim->missile_grid, j);
+			entities_release(&sim->interceptors, i);
+		}
+	}
+}
+
+// Funo que procura o mssil de menor ndice que passou a no mximo INTERCEPT_TOLERANCE do
+// interceptor em (x, y) com velocidade (vx, vy) em algum instante dos ltimos dt segundos
+int find_intercepted(struct Simulation* sim, real_t x, real_t y, real_t vx, real_t vy, float dt) {
+	const struct Grid* g = &sim->missile_grid;
+	const struct EntityStore* m = &sim->missiles;
+	real_t step = real_from_float(dt);
+	float px = real_to_float(x);
+	float py = real_to_float(y);
+	float cell = real_to_float(g->cell_size);
+	float speed = sqrtf(real_to_float(vx) * real_to_float(vx) + real_to_float(vy) * real_to_float(vy));
+	// Um mssil interceptado no passo est hoje a no mximo a tolerncia mais o deslocamento
+	// relativo do passo, que  limitado pela soma das velocidades
+	float reach = (float)INTERCEPT_TOLERANCE + (speed + sim->missile_speed_bound) * dt;
+	// Clulas que o quadrado em volta do alcance toca (com dt = 0, no mximo 3 x 3 como antes)
+	int c0 = (int)floorf((px - reach) / cell);
+	int c1 = (int)floorf((px + reach) / cell);
+	int r0 = (int)floorf((py - reach) / cell);
+	int r1 = (int)floorf((py + reach) / cell);
+	int found = -1;
+
+	c0 = c0 < 0 ? 0 : c0;
+	r0 = r0 < 0 ? 0 : r0;
+	c1 = c1 >= g->cols ? g->cols - 1 : c1;
+	r1 = r1 >= g->rows ? g->rows - 1 : r1;
+	for (int r = r0; r <= r1; r++) {
+		float ny = py < r * cell ? r * cell : (py > (r + 1) * cell ? (r + 1) * cell : py);
+		float room = reach * reach - (ny - py) * (ny - py);
+
+		for (int c = c0; c <= c1; c++) {
+			int j = g->head[r * g->cols + c];
+			float nx;
+
+			if (j < 0) {
+				continue;
+			}
+
+			// Pula as clulas cujo ponto mais prximo j est fora do alcance
+			nx = px < c * cell ? c * cell : (px > (c + 1) * cell ? (c + 1) * cell : px);
+			if ((nx - px) * (nx - px) > room) {
+				continue;
+			}
+
+			for (; j >= 0; j = g->next[j]) {
+				// S testa msseis direcionados a uma rea habitada
+				if (m->targeted[j] && (found < 0 || j < found)
+					&& is_intercepted_swept(x, y, m->x[j], m->y[j], vx - m->vx[j], vy - m->vy[j], step)) {
+					found = j;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+void describe_missile(struct Simulation* sim, struct LaunchDescriptor* d, double now, float x, float y, float angle, float speed,
+	float vx, float vy) {
+	// Atribui o identificador, o instante e os valores de x, y, angle, speed, vx e vy ao descritor
+	d->id = sim->next_missile_id++;
+	d->launch_time = now;
+	d->threat_time = now;
+	d->x = x;
+	d->y = y;
+	d->angle = angle;
+	d->speed = speed;
+
+	d->vx = vx;
+	d->vy = vy;
+
+	// Prev quando a trajetria sai da janela grfica e procura a primeira rea habitada que ela
+	// atinge antes disso (em caso de empate fica a rea de menor ndice), s nas clulas do ndice
+	// por onde ela passa
+	double end = ballistic_window_exit(x, y, vx, vy, GRAVITY, sim->config.width, sim->config.height);
+	d->impact_area = area_index_trajectory(&sim->area_index, sim->areas, x, y, vx, vy, GRAVITY, &end);
+
+	// O mssil est direcionado a uma rea habitada se a trajetria termina nela
+	d->targeted = d->impact_area >= 0;
+	d->impact_time = now + end;
+	ballistic_position(x, y, vx, vy, GRAVITY, end, &d->impact_x, &d->impact_y);
+}
+
+// Funo que reserva um ndice livre para a entidade descrita por d e a coloca nele, j avanada
+// at o tempo atual. Retorna o identificador, ou ENTITY_NONE se o conjunto estiver cheio.
+static EntityHandle place(struct Simulation* sim, struct EntityStore* s, const struct LaunchDescriptor* d) {
+	// O descritor pode chegar um pouco depois do lanamento: avana a trajetria pelo atraso
+	double late = sim->time > d->launch_time ? sim->time - d->launch_time : 0;
+	EntityHandle h = entities_alloc(s);
+	int i = ENTITY_INDEX(h);
+	float x, y;
+
+	if (h == ENTITY_NONE) {
+		return ENTITY_NONE;
+	}
+
+	ballistic_position(d->x, d->y, d->vx, d->vy, GRAVITY, late, &x, &y);
+	s->x[i] = real_from_float(x);
+	s->y[i] = real_from_float(y);
+	s->vx[i] = real_from_float(d->vx);
+	s->vy[i] = real_from_float(ballistic_velocity(d->vy, GRAVITY, late));
+	s->angle[i] = d->angle;
+	s->speed[i] = d->speed;
+	s->targeted[i] = (uint8_t)d->targeted;
+	s->impact_time[i] = d->impact_time;
+	s->impact_area[i] = (int16_t)d->impact_area;
+
+	// Ativa a entidade
+	entities_set_active(s, i, 1);
+	return h;
+}
+
+EntityHandle launch_missile(struct Simulation* sim, const struct LaunchDescriptor* d) {
+	// Ocupa um ndice livre, sem sobrescrever msseis de ondas anteriores ainda em voo
+	EntityHandle h = place(sim, &sim->missiles, d);
+
+	if (h == ENTITY_NONE) {
+		stats_add(&sim->counters, STATS_MONITOR, STATS_DROPPED, 1);
+	}
+	else {
+		// Enquanto est na janela, y no desce mais do que a altura abaixo do lanamento, ento a
+		// velocidade nunca passa de sqrt(v0 + 2 g altura)
+		float bound = sqrtf(d->vx * d->vx + d->vy * d->vy + 2 * (float)GRAVITY * sim->config.height);
+
+		if (bound > sim->missile_speed_bound) {
+			sim->missile_speed_bound = bound;
+		}
+
+		if (d->impact_area >= 0 && d->impact_time < sim->next_impact) {
+			// Antecipa a prxima verificao de impactos em update
+			sim->next_impact = d->impact_time;
+		}
+	}
+	return h;
+}
+
+int is_in_area(float x, float y, struct Area* a) {
+	
+	if (x >= a->x && x <= a->x + a->width && y >= a->y && y <= a->y + a->height) {
+		// O mssil est dentro da rea
+		return 1;
+	}
+	else {
+		// O mssil no est dentro da rea
+		return 0;
+	}
+}
+
+int find_area(struct Simulation* sim, float x, float y) {
+	return area_index_find(&sim->area_index, sim->areas, x, y);
+}
+
+int is_intercepted(real_t x1, real_t y1, real_t x2, real_t y2) {
+	
+	// Compara as distncias ao quadrado, evitando a raiz quadrada (em ponto fixo, com produtos exatos em 64 bits)
+	real_wide_t tolerance = real_from_float(INTERCEPT_TOLERANCE);
+	real_wide_t dx = x1 - x2;
+	real_wide_t dy = y1 - y2;
+	real_wide_t distance2 = dx * dx + dy * dy;
+
+	if (distance2 <= tolerance * tolerance) {
+		// Os msseis se interceptaram
+		return 1;
+	}
+	else {
+		// Os msseis no se interceptaram
+		return 0;
+	}
+}
+
+// Funo que calcula o instante s em [0, dt] em que a distncia d + dv s fica mnima
+static real_t closest_time(real_t dx, real_t dy, real_t dvx, real_t dvy, real_t dt) {
+	real_wide_t u = -((real_wide_t)dx * dvx + (real_wide_t)dy * dvy); // s vezes |dv|
+	real_wide_t w = (real_wide_t)dvx * dvx + (real_wide_t)dvy * dvy; // |dv|
+
+	if (u <= 0) {
+		// Os dois j estavam se afastando no incio do passo
+		return 0;
+	}
+
+#if SIM_FIXED_POINT
+	// u e w so produtos em Q32.32; dividir por w em Q16.16 d o instante em Q16.16
+	int64_t d = w >> FX_SHIFT;
+	return d == 0 || u / d >= dt ? dt : (real_t)(u / d);
+#else
+	return u >= w * dt ? dt : u / w;
+#endif
+}
+
+int is_intercepted_swept(real_t x1, real_t y1, real_t x2, real_t y2, real_t dvx, real_t dvy, real_t dt) {
+	// Os dois esto sob a mesma gravidade, ento no passo o movimento relativo  retilneo e
+	// uniforme: a distncia no incio do passo  a atual menos dv dt, e basta testar o ponto de
+	// maior aproximao do segmento relativo
+	real_t dx = x1 - x2 - real_mul(dvx, dt);
+	real_t dy = y1 - y2 - real_mul(dvy, dt);
+	real_t s = closest_time(dx, dy, dvx, dvy, dt);
+
+	return is_intercepted(dx + real_mul(dvx, s), dy + real_mul(dvy, s), 0, 0);
+}
+
+// Talvez precise
+float to_radians(float degrees) {
+
+	// Converte graus em radianos usando a frmula
+	float radians = degrees * PI / 180;
+
+	// Retorna o resultado
+	return radians;
+}
+
+float to_degrees(float radians) {
+
+	// Converte radianos em graus usando a frmula
+	float degrees = radians * 180 / PI;
+
+	// Retorna o resultado
+	return degrees;
+}
+
+void describe_interceptor(struct Simulation* sim, struct LaunchDescriptor* d, double now, float x, float y, float angle, float speed,
+	float vx, float vy) {
+	// Atribui o identificador, o instante e os valores de x, y, angle, speed, vx e vy ao descritor
+	d->id = sim->next_interceptor_id++;
+	d->launch_time = now;
+	d->threat_time = now;
+	d->x = x;
+	d->y = y;
+	d->angle = angle;
+	d->speed = speed;
+
+	// Os lanadores ficam na borda inferior, ento a velocidade y  sempre para cima (negativa)
+	d->vx = vx;
+	d->vy = vy;
+
+	// No  necessrio verificar se o interceptor est direcionado a uma rea habitada, pois ele s  lanado para interceptar msseis que j esto
+	// indo para uma area habitada
+	d->targeted = 0;
+	d->impact_area = -1;
+	d->impact_time = now + ballistic_window_exit(x, y, d->vx, d->vy, GRAVITY, sim->config.width, sim->config.height);
+	ballistic_position(x, y, d->vx, d->vy, GRAVITY, d->impact_time - now, &d->impact_x, &d->impact_y);
+}
+
+EntityHandle launch_interceptor(struct Simulation* sim, const struct LaunchDescriptor* d) {
+	// Ocupa um ndice livre do conjunto de interceptores
+	EntityHandle h = place(sim, &sim->interceptors, d);
+
+	if (h == ENTITY_NONE) {
+		stats_add(&sim->counters, STATS_MONITOR, STATS_DROPPED, 1);
+	}
+	return h;
+}
+
+int calculate_intercept(struct Simulation* sim, const struct LaunchDescriptor* threat, double now, int launcher, float* angle, float* speed,
+	float* vx, float* vy, float* time) {
+	const struct Launcher* l = &sim->launchers[launcher];
+	struct InterceptSolution solution;
+	float x, y;
+	double age = now - threat->launch_time;
+
+	// Estima o estado atual do mssil a partir do seu descritor
+	ballistic_position(threat->x, threat->y, threat->vx, threat->vy, GRAVITY, age, &x, &y);
+
+	// Calcula o encontro mais cedo possvel, antes de o mssil sair da janela grfica
+	if (!ballistic_intercept(x, y, threat->vx, ballistic_velocity(threat->vy, GRAVITY, age), l->x, l->y, GRAVITY,
+		INTERCEPTOR_MAX_SPEED, threat->impact_time - now, sim->config.width, sim->config.height, &solution)) {
+		return 0;
+	}
+
+	// Guarda tambm o ngulo de elevao e a velocidade, no sentido de describe_interceptor
+	// (que lana da direita para a esquerda, com a componente x negada, e para cima, com a y negada)
+	*vx = solution.vx;
+	*vy = solution.vy;
+	*angle = to_degrees(fm_atan2(-solution.vy, -solution.vx));
+	*speed = sqrtf(solution.vx * solution.vx + solution.vy * solution.vy);
+	*time = solution.time;
+
+	return 1;
+}
@@ -0,0 +1,133 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "areas.h"
+#include "entities.h"
+#include "grid.h"
+#include "rng.h"
+#include "stats.h"
+
+// Define algumas constantes para o sistema. As capacidades so apenas os valores padro de
+// struct SimConfig, que pode mud-las na inicializao sem recompilar.
+#define NUM_MISSILES 10 // Nmero mximo de msseis por ataque
+#define NUM_INTERCEPTORS 5 // Nmero mximo de interceptores por defesa
+#define MAX_MISSILES 128 // Nmero mximo de msseis em voo ao mesmo tempo (capacidade do conjunto)
+#define MAX_INTERCEPTORS 64 // Nmero mximo de interceptores em voo ao mesmo tempo (capacidade do conjunto)
+#define NUM_AREAS 3 // Nmero de reas habitadas
+#define MAX_AREAS 32767 // Limite do nmero de reas (o ndice da rea atingida  guardado em 16 bits)
+#define NUM_LAUNCHERS 1 // Nmero de lanadores de interceptores
+#define MAX_LAUNCHERS 16 // Limite do nmero de lanadores
+#define ATTACK_INTERVAL 5000 // Intervalo entre ataques em milissegundos
+#define DEFENSE_INTERVAL 1000 // Intervalo mnimo entre salvas da defesa em milissegundos
+#define ATTACK_QUEUE_LENGTH 10 // Nmero de ondas de ataque que podem aguardar a defesa
+#define DESCRIPTOR_RING_CAPACITY 128 // Capacidade dos anis de descritores (potncia de 2 >= ATTACK_QUEUE_LENGTH * NUM_MISSILES)
+#define WINDOW_WIDTH 800 // Largura da janela grfica
+#define WINDOW_HEIGHT 600 // Altura da janela grfica
+#define GRAVITY 9.8 // Acelerao da gravidade (unidades/s)
+#define MONITOR_PERIOD_MS 10 // Perodo da tarefa de monitor em milissegundos
+#define SIM_DT (MONITOR_PERIOD_MS / 1000.0f) // Passo fixo da simulao em segundos
+#define MAX_SUBSTEPS 5 // Nmero mximo de passos por ativao do monitor para recuperar atrasos
+#define PI 3.14159 // Valor de pi
+#define INTERCEPT_TOLERANCE 10.0 // Distncia mxima para considerar um mssil interceptado
+#define INTERCEPTOR_MAX_SPEED 300 // Velocidade mxima de lanamento dos interceptores (unidades/s)
+#define GRID_CELL_SIZE 10 // Lado das clulas da grade de coliso (igual  tolerncia de interceptao)
+#define SIM_DEFAULT_SEED 1 // Semente padro dos geradores aleatrios
+#define SIM_FIXED_STEP_MARGIN 4096.0f // Deslocamento mximo de uma entidade num passo em ponto fixo (unidades)
+// Maior largura ou altura da janela em ponto fixo: Q16.16 vai at 32767, e uma entidade ainda anda
+// um passo alm da borda antes de ser liberada
+#define SIM_FIXED_MAX_EXTENT (32767.0f - SIM_FIXED_STEP_MARGIN)
+
+// Configurao escolhida na inicializao: capacidades, profundidade dos anis e tamanho da janela
+struct SimConfig {
+	int missiles_per_wave; // Nmero mximo de msseis por ataque
+	int interceptors_per_defense; // Nmero mximo de interceptores por salva da defesa
+	int max_missiles; // Nmero mximo de msseis em voo ao mesmo tempo
+	int max_interceptors; // Nmero mximo de interceptores em voo ao mesmo tempo
+	int num_areas; // Nmero de reas habitadas (at MAX_AREAS)
+	const struct Area* area_list; // reas fixas (num_areas, lidas de um arquivo), ou NULL para sorte-las
+	int num_launchers; // Nmero de lanadores de interceptores (at MAX_LAUNCHERS)
+	unsigned int ring_capacity; // Capacidade dos anis de descritores (potncia de 2, pelo menos missiles_per_wave)
+	float width; // Largura da janela grfica
+	float height; // Altura da janela grfica
+	uint64_t seed; // Semente dos geradores aleatrios, usada em init
+};
+
+// Define algumas estruturas de dados para o sistema (struct Area fica em areas.h)
+// Lanador de interceptores, na borda inferior da janela
+struct Launcher {
+	float x; // Posio x do lanador
+	float y; // Posio y do lanador
+};
+
+// Descritor de um lanamento (de mssil ou de interceptor).  uma cpia consistente do estado
+// inicial, ento quem o recebe pode prever a trajetria sem ler os vetores da simulao.
+struct LaunchDescriptor {
+	uint32_t id; // Identificador do lanamento
+	double launch_time; // Instante do lanamento em segundos de simulao
+	float x; // Posio x de lanamento
+	float y; // Posio y de lanamento
+	float vx; // Velocidade x de lanamento
+	float vy; // Velocidade y de lanamento
+	float angle; // ngulo de lanamento
+	float speed; // Velocidade de lanamento
+	float impact_x; // Posio x prevista do fim da trajetria (impacto numa rea ou sada da janela grfica)
+	float impact_y; // Posio y prevista do fim da trajetria
+	double impact_time; // Instante previsto do fim da trajetria
+	double threat_time; // Instante do lanamento do mssil a que o interceptor responde (nos msseis, o prprio lanamento)
+	int impact_area; // rea habitada atingida no fim da trajetria, ou -1 se nenhuma
+	int targeted; // Indica se o mssil est direcionado a uma rea habitada (impact_area >= 0)
+};
+
+// Estado completo de uma simulao. No depende do FreeRTOS, ento pode ser usado tanto pelas
+// tarefas quanto pelo modo em lote, em que cada cenrio tem a sua prpria simulao.
+struct Simulation {
+	struct SimConfig config; // Configurao com que a simulao foi criada
+	struct EntityStore missiles; // Msseis
+	struct EntityStore interceptors; // Interceptores
+	struct Grid missile_grid; // Grade uniforme com os msseis ativos, usada na verificao de interceptao
+	struct Area* areas; // Vetor de config.num_areas reas habitadas
+	struct AreaIndex area_index; // ndice espacial das reas, montado em init
+	struct Launcher* launchers; // Vetor de config.num_launchers lanadores
+	struct StatsCounters counters; // Msseis, interceptores, acertos, interceptaes e descartes, uma cpia por tarefa
+	struct Rng area_rng; // Gerador das reas sorteadas em init
+	struct Rng attack_rng; // Gerador das ondas e dos intervalos de ataque (usado apenas pelo ataque)
+	double time; // Tempo simulado em segundos (escrito apenas pelo monitor)
+	double next_impact; // Instante do prximo impacto previsto numa rea (nunca depois do real)
+	float missile_speed_bound; // Maior velocidade que um mssil em voo pode ter, usada no alcance de find_intercepted
+	uint32_t next_missile_id; // Prximo identificador de mssil (escrito apenas pelo ataque)
+	uint32_t next_interceptor_id; // Prximo identificador de interceptor (escrito apenas pela defesa)
+
+	// Memria retirada da arena por sim_create
+	void* missile_storage; // Armazenamento dos msseis (estrutura de vetores alinhados)
+	void* interceptor_storage; // Armazenamento dos interceptores
+	void* missile_grid_storage; // Grade de coliso
+	float* wave_scratch; // ngulos, velocidades e componentes de uma onda de ataque
+};
+
+// Declara as funes do sistema
+void sim_default_config(struct SimConfig *config); // Preenche a configurao com os valores padro
+size_t sim_arena_bytes(const struct SimConfig *config); // Calcula quantos bytes de arena sim_create usa
+int sim_create(struct Simulation *sim, const struct SimConfig *config, struct Arena *arena); // Reserva a memria da simulao na arena (0 se conseguiu)
+void init(struct Simulation *sim); // Inicializa o sistema (e os geradores aleatrios com config.seed)
+void update(struct Simulation *sim, float dt); // Atualiza o estado do sistema avanando dt segundos
+int attack_wave(struct Simulation *sim, double now, struct LaunchDescriptor *wave); // Gera uma onda de ataque e retorna o nmero de msseis
+void describe_missile(struct Simulation *sim, struct LaunchDescriptor *d, double now, float x, float y, float angle, float speed, float vx, float vy); // Preenche o descritor de um mssil
+void describe_interceptor(struct Simulation *sim, struct LaunchDescriptor *d, double now, float x, float y, float angle, float speed, float vx, float vy); // Preenche o descritor de um interceptor
+EntityHandle launch_missile(struct Simulation *sim, const struct LaunchDescriptor *d); // Lana um mssil a partir do seu descritor
+EntityHandle launch_interceptor(struct Simulation *sim, const struct LaunchDescriptor *d); // Lana um interceptor a partir do seu descritor
+int is_in_area(float x, float y, struct Area *a); // Verifica se um ponto est dentro de uma rea
+int find_area(struct Simulation *sim, float x, float y); // Procura a rea de menor ndice que contm um ponto (-1 se nenhuma)
+int is_intercepted(real_t x1, real_t y1, real_t x2, real_t y2); // Verifica se um mssil foi interceptado por outro
+int is_intercepted_swept(real_t x1, real_t y1, real_t x2, real_t y2, real_t dvx, real_t dvy, real_t dt); // Verifica se dois objetos, hoje em (x1, y1) e (x2, y2) e com velocidade relativa (dvx, dvy), passaram a menos da tolerncia nos ltimos dt segundos
+int find_intercepted(struct Simulation *sim, real_t x, real_t y, real_t vx, real_t vy, float dt); // Procura um mssil interceptado nos ltimos dt segundos por um interceptor
+float to_radians(float degrees); // Converte graus em radianos
+float to_degrees(float radians); // Converte radianos em graus
+
+int calculate_intercept(struct Simulation *sim, const struct LaunchDescriptor *threat, double now, int launcher, float *angle, float *speed,
+	float *vx, float *vy, float *time); // Calcula o lanamento de um lanador que intercepta uma ameaa e o tempo de voo at o encontro
+
+#endif
@@ -0,0 +1,130 @@
+#include <string.h>
+
+#include "snapshot.h"
+
+// Funo que calcula o nmero mximo de entidades de um quadro
+static size_t frame_capacity(const struct SimConfig* config) {
+	return ENTITY_ROUND_CAPACITY(config->max_missiles) + ENTITY_ROUND_CAPACITY(config->max_interceptors);
+}
+
+// Funo que calcula quantos bytes de arena um quadro usa
+static size_t frame_bytes(const struct SimConfig* config) {
+	return 2 * ARENA_BYTES(frame_capacity(config) * sizeof(float), sizeof(float))
+		+ ARENA_BYTES(config->num_areas, 1);
+}
+
+size_t snapshot_arena_bytes(const struct SimConfig* config) {
+	return 2 * frame_bytes(config);
+}
+
+int snapshot_frame_create(struct SnapshotFrame* f, const struct SimConfig* config, struct Arena* arena) {
+	size_t n = frame_capacity(config);
+
+	f->time = 0;
+	f->hits = 0;
+	f->intercepts = 0;
+	f->missiles = 0;
+	f->interceptors = 0;
+	f->x = arena_alloc(arena, n * sizeof(float), sizeof(float));
+	f->y = arena_alloc(arena, n * sizeof(float), sizeof(float));
+	f->area_hit = arena_alloc(arena, config->num_areas, 1);
+	if (f->x == NULL || f->y == NULL || f->area_hit == NULL) {
+		return -1;
+	}
+	memset(f->area_hit, 0, config->num_areas);
+	return 0;
+}
+
+int snapshot_create(struct Snapshot* s, const struct SimConfig* config, struct Arena* arena) {
+	s->capacity = (int)frame_capacity(config);
+	s->num_areas = config->num_areas;
+	atomic_init(&s->latest, -1);
+
+	for (int b = 0; b < 2; b++) {
+		atomic_init(&s->buffers[b].sequence, 0);
+		if (snapshot_frame_create(&s->buffers[b].frame, config, arena) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// Funo que copia as posies das entidades ativas de um armazenamento, a partir de x e y
+static int pack_store(const struct EntityStore* store, float* x, float* y) {
+	int n = 0;
+
+	for (int i = entities_next_active(store, 0); i >= 0; i = entities_next_active(store, i + 1)) {
+		x[n] = real_to_float(store->x[i]);
+		y[n] = real_to_float(store->y[i]);
+		n++;
+	}
+	return n;
+}
+
+void snapshot_publish(struct Snapshot* s, const struct Simulation* sim) {
+	// Escreve no buffer que no  o ltimo publicado, ento os leitores dele no so incomodados
+	int b = atomic_load_explicit(&s->latest, memory_order_relaxed) == 0 ? 1 : 0;
+	struct SnapshotBuffer* buffer = &s->buffers[b];
+	struct SnapshotFrame* f = &buffer->frame;
+	unsigned int sequence = atomic_load_explicit(&buffer->sequence, memory_order_relaxed);
+
+	// Sequncia mpar: quem comear a ler agora descarta a cpia
+	atomic_store_explicit(&buffer->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	f->time = sim->time;
+	f->hits = stats_read(&sim->counters, STATS_HITS);
+	f->intercepts = stats_read(&sim->counters, STATS_INTERCEPTS);
+	f->missiles = pack_store(&sim->missiles, f->x, f->y);
+	f->interceptors = pack_store(&sim->interceptors, f->x + f->missiles, f->y + f->missiles);
+	for (int a = 0; a < s->num_areas; a++) {
+		f->area_hit[a] = (uint8_t)(sim->areas[a].hit != 0);
+	}
+
+	atomic_store_explicit(&buffer->sequence, sequence + 2, memory_order_release);
+	atomic_store_explicit(&s->latest, b, memory_order_release);
+}
+
+int snapshot_read(struct Snapshot* s, struct SnapshotFrame* out) {
+	for (int attempt = 0; attempt < SNAPSHOT_READ_RETRIES; attempt++) {
+		int b = atomic_load_explicit(&s->latest, memory_order_acquire);
+		struct SnapshotBuffer* buffer;
+		const struct SnapshotFrame* f;
+		unsigned int before, after;
+		int missiles, interceptors;
+
+		if (b < 0) {
+			return 0;
+		}
+		buffer = &s->buffers[b];
+		f = &buffer->frame;
+
+		before = atomic_load_explicit(&buffer->sequence, memory_order_acquire);
+		if (before & 1) {
+			continue;
+		}
+
+		// Os campos podem estar sendo reescritos: as quantidades so limitadas antes de copiar,
+		// e a cpia s vale se a sequncia no mudou
+		out->time = f->time;
+		out->hits = f->hits;
+		out->intercepts = f->intercepts;
+		missiles = f->missiles;
+		interceptors = f->interceptors;
+		if (missiles < 0 || interceptors < 0 || missiles > s->capacity || interceptors > s->capacity - missiles) {
+			continue;
+		}
+		memcpy(out->x, f->x, (size_t)(missiles + interceptors) * sizeof(float));
+		memcpy(out->y, f->y, (size_t)(missiles + interceptors) * sizeof(float));
+		memcpy(out->area_hit, f->area_hit, (size_t)s->num_areas);
+
+		atomic_thread_fence(memory_order_acquire);
+		after = atomic_load_explicit(&buffer->sequence, memory_order_relaxed);
+		if (before == after) {
+			out->missiles = missiles;
+			out->interceptors = interceptors;
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "simulation.h"
+
+#define SNAPSHOT_CACHE_LINE 64 // Tamanho de uma linha de cache
+#define SNAPSHOT_READ_RETRIES 4 // Tentativas de leitura antes de desistir de um quadro
+
+// Cpia do estado visvel da simulao num passo: posies das entidades ativas, contadores e
+// reas atingidas
+struct SnapshotFrame {
+	double time; // Tempo simulado
+	unsigned int hits; // Msseis que atingiram as reas
+	unsigned int intercepts; // Msseis interceptados
+	int missiles; // Nmero de msseis ativos
+	int interceptors; // Nmero de interceptores ativos
+	float* x; // Posies x dos msseis ativos seguidas das dos interceptores ativos
+	float* y; // Posies y, na mesma ordem
+	uint8_t* area_hit; // Indica para cada rea se ela foi atingida
+};
+
+// Buffer protegido por seqlock: a sequncia  mpar enquanto o escritor o preenche
+struct SnapshotBuffer {
+	_Alignas(SNAPSHOT_CACHE_LINE) atomic_uint sequence; // Sequncia do seqlock
+	struct SnapshotFrame frame; // Quadro
+};
+
+// Publicao do estado para leitores de baixa prioridade. O nico escritor (o monitor) alterna
+// entre dois buffers e indica em latest o ltimo completo; quem l copia esse buffer e confere a
+// sequncia. O escritor nunca espera pelos leitores, e um leitor s perde a corrida se o escritor
+// voltar ao mesmo buffer durante a cpia, ou seja, se a cpia demorar mais que um passo.
+struct Snapshot {
+	struct SnapshotBuffer buffers[2]; // Buffers alternados
+	_Alignas(SNAPSHOT_CACHE_LINE) atomic_int latest; // ltimo buffer publicado, ou -1 se nenhum
+	int capacity; // Nmero mximo de entidades de um quadro
+	int num_areas; // Nmero de reas
+};
+
+// Calcula quantos bytes de arena snapshot_create usa para uma configurao
+size_t snapshot_arena_bytes(const struct SimConfig* config);
+
+// Reserva os dois buffers na arena. Retorna 0 se conseguiu.
+int snapshot_create(struct Snapshot* s, const struct SimConfig* config, struct Arena* arena);
+
+// Reserva na arena um quadro para o leitor copiar os publicados. Retorna 0 se conseguiu.
+int snapshot_frame_create(struct SnapshotFrame* f, const struct SimConfig* config, struct Arena* arena);
+
+// Publica o estado atual da simulao (s o monitor, depois de cada update)
+void snapshot_publish(struct Snapshot* s, const struct Simulation* sim);
+
+// Copia o ltimo quadro publicado para out, sem bloquear o escritor. Retorna 0 se ainda no h
+// quadro publicado ou se todas as tentativas colidiram com o escritor (nesse caso out no deve ser usado).
+int snapshot_read(struct Snapshot* s, struct SnapshotFrame* out);
+
+#endif
@@ -0,0 +1,117 @@
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "stats.h"
+
+void stats_reset(struct StatsCounters* c) {
+	for (int s = 0; s < STATS_SOURCES; s++) {
+		for (int k = 0; k < STATS_COUNTERS; k++) {
+			atomic_store_explicit(&c->shard[s].count[k], 0, memory_order_relaxed);
+		}
+	}
+}
+
+unsigned int stats_read(const struct StatsCounters* c, enum StatsCounter counter) {
+	unsigned int total = 0;
+
+	for (int s = 0; s < STATS_SOURCES; s++) {
+		total += atomic_load_explicit(&c->shard[s].count[counter], memory_order_relaxed);
+	}
+	return total;
+}
+
+// Funo que retorna a posio do bit mais significativo de um valor no nulo
+static int msb64(uint64_t v) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	if (v >> 32) {
+		_BitScanReverse(&index, (unsigned long)(v >> 32));
+		return (int)index + 32;
+	}
+	_BitScanReverse(&index, (unsigned long)v);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(v);
+#endif
+}
+
+// Funo que calcula o balde de um valor
+static int bucket_of(uint64_t v) {
+	int e;
+
+	if (v < HIST_SUB) {
+		return (int)v;
+	}
+	e = msb64(v);
+	return (e - HIST_SUB_BITS + 1) * HIST_SUB + (int)((v >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+// Funo que calcula o maior valor de um balde
+static uint64_t bucket_high(int b) {
+	int shift;
+
+	if (b < HIST_SUB) {
+		return (uint64_t)b;
+	}
+	shift = b / HIST_SUB - 1;
+	return (((uint64_t)(HIST_SUB + b % HIST_SUB) + 1) << shift) - 1;
+}
+
+void hist_reset(struct Histogram* h) {
+	for (int b = 0; b < HIST_BUCKETS; b++) {
+		atomic_store_explicit(&h->count[b], 0, memory_order_relaxed);
+	}
+	atomic_store_explicit(&h->sum, 0, memory_order_relaxed);
+	atomic_store_explicit(&h->max, 0, memory_order_relaxed);
+}
+
+void hist_record(struct Histogram* h, uint64_t value) {
+	atomic_uint* c = &h->count[bucket_of(value)];
+
+	atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+	atomic_store_explicit(&h->sum, atomic_load_explicit(&h->sum, memory_order_relaxed) + value, memory_order_relaxed);
+	if (value > atomic_load_explicit(&h->max, memory_order_relaxed)) {
+		atomic_store_explicit(&h->max, value, memory_order_relaxed);
+	}
+}
+
+uint64_t hist_total(const struct Histogram* h) {
+	uint64_t total = 0;
+
+	for (int b = 0; b < HIST_BUCKETS; b++) {
+		total += atomic_load_explicit(&h->count[b], memory_order_relaxed);
+	}
+	return total;
+}
+
+uint64_t hist_percentile(const struct Histogram* h, double p) {
+	uint64_t total = hist_total(h);
+	uint64_t rank = (uint64_t)(p / 100.0 * total + 0.5);
+	uint64_t seen = 0;
+
+	if (total == 0) {
+		return 0;
+	}
+	if (rank < 1) {
+		rank = 1;
+	}
+
+	for (int b = 0; b < HIST_BUCKETS; b++) {
+		seen += atomic_load_explicit(&h->count[b], memory_order_relaxed);
+		if (seen >= rank) {
+			return bucket_high(b);
+		}
+	}
+	return atomic_load_explicit(&h->max, memory_order_relaxed);
+}
+
+void hist_print(const struct Histogram* h, const char* name, FILE* out) {
+	uint64_t total = hist_total(h);
+	double mean = total > 0 ? (double)atomic_load_explicit(&h->sum, memory_order_relaxed) / total : 0;
+
+	fprintf(out, "%-22s n=%-8llu mdia %10.1f  p50 %10.1f  p90 %10.1f  p99 %10.1f  p99.9 %10.1f  mx %10.1f us\n",
+		name, (unsigned long long)total, mean / 1000.0,
+		hist_percentile(h, 50) / 1000.0, hist_percentile(h, 90) / 1000.0, hist_percentile(h, 99) / 1000.0,
+		hist_percentile(h, 99.9) / 1000.0, atomic_load_explicit(&h->max, memory_order_relaxed) / 1000.0);
+}
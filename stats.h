@@ -0,0 +1,84 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Estatsticas sem travas. Cada contador  dividido em uma cpia por tarefa, em linhas de cache
+// separadas: cada tarefa s escreve a sua cpia (com load e store relaxados, sem operao atmica
+// de leitura e escrita) e quem l soma todas as cpias.
+
+#define STATS_CACHE_LINE 64 // Tamanho de uma linha de cache
+
+// Tarefa que escreve um contador. No modo em lote as trs partes rodam na mesma thread.
+enum StatsSource {
+	STATS_ATTACK, // Tarefa de ataque (attack_wave)
+	STATS_DEFENSE, // Tarefa de defesa (defense_assign)
+	STATS_MONITOR, // Tarefa de monitor (update, lanamentos e motor de eventos)
+	STATS_SOURCES
+};
+
+// Contadores da simulao
+enum StatsCounter {
+	STATS_MISSILES, // Msseis disparados pelo ataque
+	STATS_INTERCEPTORS, // Interceptores disparados pela defesa
+	STATS_HITS, // Msseis que atingiram as reas
+	STATS_INTERCEPTS, // Msseis interceptados
+	STATS_DROPPED, // Lanamentos descartados por falta de ndice livre
+	STATS_COUNTERS
+};
+
+// Cpia dos contadores escrita por uma nica tarefa
+struct StatsShard {
+	_Alignas(STATS_CACHE_LINE) atomic_uint count[STATS_COUNTERS];
+};
+
+// Contadores de uma simulao
+struct StatsCounters {
+	struct StatsShard shard[STATS_SOURCES];
+};
+
+// Zera todos os contadores (antes de as tarefas comearem)
+void stats_reset(struct StatsCounters* c);
+
+// Soma os contadores de todas as tarefas
+unsigned int stats_read(const struct StatsCounters* c, enum StatsCounter counter);
+
+// Soma n ao contador da tarefa source. S pode ser chamada pela prpria tarefa.
+static inline void stats_add(struct StatsCounters* c, enum StatsSource source, enum StatsCounter counter, unsigned int n) {
+	atomic_uint* v = &c->shard[source].count[counter];
+	atomic_store_explicit(v, atomic_load_explicit(v, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+// Histograma log-linear (no estilo HDR): valores menores que HIST_SUB ficam em baldes exatos e cada
+// potncia de 2 acima disso  dividida em HIST_SUB baldes, ento o erro relativo de qualquer
+// percentil  no mximo 1/HIST_SUB, com memria fixa para qualquer valor de 64 bits.
+// Tambm tem um nico escritor; quem l pode faz-lo a qualquer momento.
+#define HIST_SUB_BITS 4 // Bits de mantissa de cada balde
+#define HIST_SUB (1 << HIST_SUB_BITS) // Baldes por potncia de 2
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB) // Nmero de baldes
+
+struct Histogram {
+	atomic_uint count[HIST_BUCKETS]; // Nmero de valores em cada balde
+	atomic_uint_least64_t sum; // Soma dos valores
+	atomic_uint_least64_t max; // Maior valor
+};
+
+// Zera o histograma
+void hist_reset(struct Histogram* h);
+
+// Registra um valor. S pode ser chamada pelo escritor do histograma.
+void hist_record(struct Histogram* h, uint64_t value);
+
+// Retorna o nmero de valores registrados
+uint64_t hist_total(const struct Histogram* h);
+
+// Retorna o maior valor do balde que contm o percentil p (entre 0 e 100)
+uint64_t hist_percentile(const struct Histogram* h, double p);
+
+// Imprime uma linha com o nmero de valores, mdia, percentis 50, 90, 99 e 99,9 e mximo,
+// com os valores (em nanossegundos) convertidos em microssegundos
+void hist_print(const struct Histogram* h, const char* name, FILE* out);
+
+#endif
@@ -0,0 +1,301 @@
+#include <math.h>
+
+#include "tick.h"
+
+// Palavras de mscara numa linha de cache: os intervalos das threads comeam em mltiplos disso,
+// para que duas threads nunca escrevam na mesma linha das mscaras
+#define TICK_WORD_BLOCK (64 / sizeof(uint32_t))
+
+// Funo que retorna o nmero de palavras da mscara de um armazenamento com capacidade n
+static int mask_words(int n) {
+	return ENTITY_ROUND_CAPACITY(n) / ENTITY_MASK_BITS;
+}
+
+size_t tick_arena_bytes(const struct SimConfig* config, int threads) {
+	size_t m = mask_words(config->max_missiles);
+	size_t i = mask_words(config->max_interceptors);
+
+	return ARENA_BYTES((size_t)threads * sizeof(struct TickWorker), 64)
+		+ 2 * ARENA_BYTES(((size_t)threads + 1) * sizeof(int), sizeof(int))
+		+ 3 * ARENA_BYTES(m * sizeof(uint32_t), 64)
+		+ ARENA_BYTES(i * sizeof(uint32_t), 64)
+		+ ARENA_BYTES(i * ENTITY_MASK_BITS * sizeof(int32_t), sizeof(int32_t));
+}
+
+// Funo que divide as palavras de uma mscara em parts intervalos com aproximadamente o mesmo
+// nmero de bits ligados. Retorna o total de bits ligados.
+static int split(const uint32_t* mask, int words, int parts, int* bounds) {
+	int total = 0;
+	int seen = 0;
+	int k = 0;
+
+	for (int w = 0; w < words; w++) {
+		total += entities_popcount(mask[w]);
+	}
+
+	bounds[0] = 0;
+	for (int q = 1; q < parts; q++) {
+		int target = (int)((int64_t)total * q / parts);
+
+		while (k < words && (seen < target || k % TICK_WORD_BLOCK != 0)) {
+			seen += entities_popcount(mask[k++]);
+		}
+		bounds[q] = k;
+	}
+	bounds[parts] = words;
+
+	return total;
+}
+
+// Fase 1 (paralela): avana os msseis e os interceptores do intervalo da thread, marca os que
+// saram da janela ou atingiram uma rea (e j os desativa, sem mexer na lista de livres) e
+// marca os msseis que precisam mudar de clula na grade
+static void integrate_phase(struct TickPool* p, int id) {
+	struct Simulation* sim = p->sim;
+	struct EntityStore* m = &sim->missiles;
+	struct EntityStore* s = &sim->interceptors;
+	int first = p->missile_bounds[id];
+	int last = p->missile_bounds[id + 1];
+	double next = HUGE_VAL;
+
+	entities_integrate_words(m, GRAVITY, p->dt, sim->config.width, sim->config.height, first, last, p->missile_exited);
+	entities_integrate_words(s, GRAVITY, p->dt, sim->config.width, sim->config.height,
+		p->interceptor_bounds[id], p->interceptor_bounds[id + 1], p->interceptor_exited);
+
+	for (int k = p->interceptor_bounds[id]; k < p->interceptor_bounds[id + 1]; k++) {
+		s->active[k] &= ~p->interceptor_exited[k];
+	}
+
+	for (int k = first; k < last; k++) {
+		uint32_t bits, hits = 0;
+
+		m->active[k] &= ~p->missile_exited[k];
+
+		// Mesma verificao de impactos de update(), s quando o prximo impacto chegou
+		bits = p->check_impacts ? m->active[k] : 0;
+		while (bits) {
+			int j = entities_ctz(bits);
+			int i = k * ENTITY_MASK_BITS + j;
+
+			bits &= bits - 1;
+			if (m->impact_area[i] < 0) {
+				continue;
+			}
+
+			if (sim->time >= m->impact_time[i]) {
+				hits |= (uint32_t)1 << j;
+			}
+			else if (m->impact_time[i] < next) {
+				next = m->impact_time[i];
+			}
+		}
+
+		m->active[k] &= ~hits;
+		p->missile_hits[k] = hits;
+	}
+
+	grid_changed(&sim->missile_grid, m, first, last, p->missile_changed);
+	p->workers[id].next_impact = next;
+}
+
+// Fase 2 (thread 0): devolve os ndices liberados na fase 1 na mesma ordem de update(),
+// contabiliza os impactos e atualiza a grade
+static void merge_integrate(struct TickPool* p) {
+	struct Simulation* sim = p->sim;
+	struct EntityStore* m = &sim->missiles;
+	int words = mask_words(m->capacity);
+	unsigned int hits = 0;
+
+	entities_release_mask(m, p->missile_exited, 0, words);
+	entities_release_mask(&sim->interceptors, p->interceptor_exited, 0, mask_words(sim->interceptors.capacity));
+
+	if (p->check_impacts) {
+		sim->next_impact = HUGE_VAL;
+		for (int k = 0; k < p->num_workers; k++) {
+			if (p->workers[k].next_impact < sim->next_impact) {
+				sim->next_impact = p->workers[k].next_impact;
+			}
+		}
+
+		for (int k = 0; k < words; k++) {
+			uint32_t bits = p->missile_hits[k];
+
+			while (bits) {
+				int i = k * ENTITY_MASK_BITS + entities_ctz(bits);
+				bits &= bits - 1;
+
+				// Marca a rea como atingida e desativa o mssil
+				sim->areas[m->impact_area[i]].hit = 1;
+				entities_release(m, i);
+				hits++;
+			}
+		}
+
+		if (hits > 0) {
+			stats_add(&sim->counters, STATS_MONITOR, STATS_HITS, hits);
+		}
+	}
+
+	grid_apply(&sim->missile_grid, m, p->missile_changed);
+}
+
+// Fase 3 (paralela): procura o mssil interceptado por cada interceptor do intervalo da thread.
+// Ningum escreve na grade nem nos msseis nesta fase.
+static void match_phase(struct TickPool* p, int id) {
+	struct Simulation* sim = p->sim;
+	const struct EntityStore* s = &sim->interceptors;
+	int last = p->interceptor_bounds[id + 1] * ENTITY_MASK_BITS;
+
+	for (int i = entities_next_active(s, p->interceptor_bounds[id] * ENTITY_MASK_BITS); i >= 0 && i < last; i = entities_next_active(s, i + 1)) {
+		p->match[i] = find_intercepted(sim, s->x[i], s->y[i], s->vx[i], s->vy[i], p->dt);
+	}
+}
+
+// Fase 4 (thread 0): confirma as interceptaes em ordem de ndice dos interceptores. O mssil
+// encontrado na fase 3  o de menor ndice entre os que estavam na grade; se ainda est ativo,
+// tambm  o de menor ndice agora. Se outro interceptor j o levou, refaz a busca.
+static void merge_match(struct TickPool* p) {
+	struct Simulation* sim = p->sim;
+	struct EntityStore* s = &sim->interceptors;
+
+	for (int i = entities_next_active(s, 0); i >= 0; i = entities_next_active(s, i + 1)) {
+		int j = p->match[i];
+
+		if (j >= 0 && !entities_is_active(&sim->missiles, j)) {
+			j = find_intercepted(sim, s->x[i], s->y[i], s->vx[i], s->vy[i], p->dt);
+		}
+
+		if (j >= 0) {
+			// Atualiza o nmero de msseis que foram interceptados
+			stats_add(&sim->counters, STATS_MONITOR, STATS_INTERCEPTS, 1);
+
+			// Desativa o mssil e o interceptor e devolve os seus ndices
+			entities_release(&sim->missiles, j);
+			grid_remove(&sim->missile_grid, j);
+			entities_release(s, i);
+		}
+	}
+}
+
+// Funo executada por cada thread de trabalho, uma rodada de fases por passo
+static void worker_main(void* arg) {
+	struct TickWorker* w = (struct TickWorker*)arg;
+	struct TickPool* p = w->pool;
+
+	while (1) {
+		host_barrier_wait(&p->barrier);
+		if (p->stop) {
+			break;
+		}
+
+		integrate_phase(p, w->id);
+		host_barrier_wait(&p->barrier);
+
+		// Espera a thread 0 terminar a fase 2
+		host_barrier_wait(&p->barrier);
+
+		match_phase(p, w->id);
+		host_barrier_wait(&p->barrier);
+	}
+}
+
+int tick_create(struct TickPool* p, struct Simulation* sim, int threads, struct Arena* arena) {
+	int m = mask_words(sim->config.max_missiles);
+	int i = mask_words(sim->config.max_interceptors);
+
+	if (threads < 1 || threads > TICK_MAX_THREADS) {
+		return -1;
+	}
+
+	p->sim = sim;
+	p->num_workers = threads;
+	p->stop = 0;
+	p->threaded = 0;
+	p->workers = arena_alloc(arena, (size_t)threads * sizeof(struct TickWorker), 64);
+	p->missile_bounds = arena_alloc(arena, ((size_t)threads + 1) * sizeof(int), sizeof(int));
+	p->interceptor_bounds = arena_alloc(arena, ((size_t)threads + 1) * sizeof(int), sizeof(int));
+	p->missile_exited = arena_alloc(arena, m * sizeof(uint32_t), 64);
+	p->missile_hits = arena_alloc(arena, m * sizeof(uint32_t), 64);
+	p->missile_changed = arena_alloc(arena, m * sizeof(uint32_t), 64);
+	p->interceptor_exited = arena_alloc(arena, i * sizeof(uint32_t), 64);
+	p->match = arena_alloc(arena, (size_t)i * ENTITY_MASK_BITS * sizeof(int32_t), sizeof(int32_t));
+
+	if (p->workers == NULL || p->missile_bounds == NULL || p->interceptor_bounds == NULL || p->missile_exited == NULL
+		|| p->missile_hits == NULL || p->missile_changed == NULL || p->interceptor_exited == NULL || p->match == NULL) {
+		return -1;
+	}
+
+	for (int k = 0; k < threads; k++) {
+		p->workers[k].id = k;
+		p->workers[k].pool = p;
+		p->workers[k].next_impact = HUGE_VAL;
+	}
+
+	if (threads == 1 || host_barrier_init(&p->barrier, threads) != 0) {
+		p->num_workers = 1;
+		return 0;
+	}
+
+	p->threaded = 1;
+	for (int k = 1; k < threads; k++) {
+		if (host_thread_start(&p->workers[k].thread, worker_main, &p->workers[k]) != 0) {
+			// Continua s com as threads j criadas
+			for (int missing = k; missing < threads; missing++) {
+				host_barrier_drop(&p->barrier);
+			}
+			p->num_workers = k;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+void tick_update(struct TickPool* p, float dt) {
+	struct Simulation* sim = p->sim;
+	int n = p->num_workers;
+	int active;
+
+	if (n == 1) {
+		update(sim, dt);
+		return;
+	}
+
+	// Com poucas entidades as barreiras custam mais do que o passo inteiro
+	active = split(sim->missiles.active, mask_words(sim->missiles.capacity), n, p->missile_bounds)
+		+ split(sim->interceptors.active, mask_words(sim->interceptors.capacity), n, p->interceptor_bounds);
+	if (active < TICK_PARALLEL_MIN) {
+		update(sim, dt);
+		return;
+	}
+
+	p->dt = dt;
+	sim->time += dt;
+	p->check_impacts = sim->time >= sim->next_impact;
+
+	// Fases 1 e 2
+	host_barrier_wait(&p->barrier);
+	integrate_phase(p, 0);
+	host_barrier_wait(&p->barrier);
+	merge_integrate(p);
+
+	// Fases 3 e 4, com os interceptores que sobraram divididos de novo
+	split(sim->interceptors.active, mask_words(sim->interceptors.capacity), n, p->interceptor_bounds);
+	host_barrier_wait(&p->barrier);
+	match_phase(p, 0);
+	host_barrier_wait(&p->barrier);
+	merge_match(p);
+}
+
+void tick_destroy(struct TickPool* p) {
+	if (!p->threaded) {
+		return;
+	}
+
+	p->stop = 1;
+	host_barrier_wait(&p->barrier);
+	for (int k = 1; k < p->num_workers; k++) {
+		host_thread_join(&p->workers[k].thread);
+	}
+	host_barrier_destroy(&p->barrier);
+}
@@ -0,0 +1,69 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "host.h"
+#include "simulation.h"
+
+// Passo paralelo da simulao, para hospedeiros com vrios ncleos (porta POSIX ou Windows).
+// tick_update tem exatamente o mesmo efeito de update(), com qualquer nmero de threads:
+//  1. cada thread avana um intervalo de palavras da mscara de msseis e de interceptores,
+//     marca os que saram da janela ou atingiram uma rea e as clulas da grade que mudaram;
+//  2. a thread que chamou tick_update libera essas entidades e atualiza a grade em ordem de ndice;
+//  3. cada thread procura, para os interceptores do seu intervalo, o mssil interceptado de menor
+//     ndice na grade, que fica s para leitura nessa fase;
+//  4. a thread que chamou confirma as interceptaes em ordem de ndice dos interceptores. Se o
+//     mssil encontrado j foi interceptado por um interceptor anterior, refaz a busca na grade
+//     atual, exatamente como update() faria.
+// Entre as fases as threads se encontram numa barreira. Os intervalos so divididos pelo nmero
+// de entidades ativas, que ficam concentradas nos primeiros ndices.
+#define TICK_MAX_THREADS 64 // Nmero mximo de threads de um passo
+#define TICK_PARALLEL_MIN 4096 // Entidades ativas abaixo das quais tick_update apenas chama update()
+
+struct TickPool;
+
+// Thread de trabalho do passo paralelo
+struct TickWorker {
+	_Alignas(64) double next_impact; // Menor instante de impacto ainda futuro no seu intervalo de msseis
+	int id; // ndice da thread (0  a que chama tick_update)
+	struct TickPool* pool; // Conjunto ao qual pertence
+	struct HostThread thread; // Thread do sistema (no usada na thread 0)
+};
+
+// Conjunto de threads que dividem o passo de uma simulao
+struct TickPool {
+	struct Simulation* sim; // Simulao avanada
+	int num_workers; // Nmero de threads, contando a que chama tick_update
+	struct TickWorker* workers; // Vetor de num_workers threads
+	struct HostBarrier barrier; // Encontro das threads entre as fases
+	int* missile_bounds; // Intervalo de palavras de msseis de cada thread (num_workers + 1 limites)
+	int* interceptor_bounds; // Intervalo de palavras de interceptores de cada thread
+	uint32_t* missile_exited; // Msseis que saram da janela grfica no passo
+	uint32_t* missile_hits; // Msseis que atingiram uma rea no passo
+	uint32_t* missile_changed; // Msseis que trocaram de clula ou saram da grade
+	uint32_t* interceptor_exited; // Interceptores que saram da janela grfica no passo
+	int32_t* match; // Mssil interceptado por cada interceptor na grade da fase 3, ou -1
+	float dt; // Durao do passo atual
+	int check_impacts; // O passo atual chegou ao instante do prximo impacto
+	int threaded; // As threads de trabalho e a barreira foram criadas
+	int stop; // Pede que as threads terminem
+};
+
+// Calcula quantos bytes de arena tick_create usa para uma configurao e um nmero de threads
+size_t tick_arena_bytes(const struct SimConfig* config, int threads);
+
+// Cria threads - 1 threads de trabalho para a simulao (a thread que chama tick_update  a
+// primeira). Se o sistema no criar alguma, o passo  dividido entre as que foram criadas.
+// Retorna 0 se conseguiu.
+int tick_create(struct TickPool* p, struct Simulation* sim, int threads, struct Arena* arena);
+
+// Atualiza o estado da simulao avanando dt segundos, com o mesmo resultado de update()
+void tick_update(struct TickPool* p, float dt);
+
+// Termina as threads de trabalho
+void tick_destroy(struct TickPool* p);
+
+#endif
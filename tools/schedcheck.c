@@ -0,0 +1,350 @@
+// Anlise de escalonabilidade offline do conjunto de tarefas, a partir dos tempos medidos pela
+// instrumentao de tempo real (rtmon.h). L o arquivo gravado com --rt-log, faz a anlise de
+// tempo de resposta com prioridades fixas rate-monotonic (menor perodo, maior prioridade) e
+// deadline-monotonic (menor prazo, maior prioridade) e os testes de EDF, e recomenda prioridades
+// e os menores perodos que mantm o conjunto escalonvel. Opcionalmente gera um cabealho com as
+// prioridades das tarefas, usado por main.c quando compilado com mainUSE_TASK_CONFIG.
+//
+// Compilao, a partir da raiz do repositrio:
+//   cc -std=c11 -O2 tools/schedcheck.c -lm -o schedcheck
+//
+// Uso: schedcheck tarefas.txt [task_config.h]
+//
+// Cada linha do arquivo de tarefas tem nome, intervalo mnimo entre liberaes, prazo relativo e
+// WCET, em microssegundos, e opcionalmente a forma de liberao (periodica, atraso ou esporadica,
+// s informativa: todas so analisadas como espordicas com o intervalo mnimo dado); linhas
+// vazias ou comeando com '#' so ignoradas. Como cada tarefa s
+//  liberada de novo depois de terminar o job anterior, prazos maiores que o intervalo so
+// tratados como iguais a ele. No h bloqueio entre as tarefas (os anis no tm travas).
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCHED_MAX_TASKS 32 // Nmero mximo de tarefas
+#define SCHED_NAME_LENGTH 32 // Tamanho mximo do nome de uma tarefa
+#define SCHED_KIND_LENGTH 16 // Tamanho mximo da forma de liberao
+#define SCHED_LINE_LENGTH 256 // Tamanho mximo de uma linha do arquivo
+#define SCHED_MAX_DEMAND_POINTS 1000000 // Prazos verificados no teste de demanda do EDF
+#define SCHED_SEARCH_STEPS 50 // Iteraes das buscas binrias
+#define SCHED_BASE_PRIORITY 1 // Prioridade da tarefa menos prioritria no cabealho gerado
+
+struct Task {
+	char name[SCHED_NAME_LENGTH]; // Nome (o mesmo passado ao xTaskCreate)
+	char kind[SCHED_KIND_LENGTH]; // Forma de liberao, ou "-" se o arquivo no a informa
+	double period; // Intervalo mnimo entre liberaes (us)
+	double deadline; // Prazo relativo, no mximo o perodo (us)
+	double wcet; // Pior tempo de execuo (us)
+};
+
+// Funo que l o conjunto de tarefas. Retorna o nmero de tarefas, ou -1 em caso de erro.
+static int read_tasks(const char* path, struct Task* tasks) {
+	char line[SCHED_LINE_LENGTH];
+	FILE* f = fopen(path, "r");
+	int n = 0;
+
+	if (f == NULL) {
+		fprintf(stderr, "no foi possvel abrir %s\n", path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		struct Task* t = &tasks[n];
+		char* p = line;
+
+		while (isspace((unsigned char)*p)) {
+			p++;
+		}
+		if (*p == '\0' || *p == '#') {
+			continue;
+		}
+		strcpy(t->kind, "-");
+		if (n == SCHED_MAX_TASKS || sscanf(p, "%31s %lf %lf %lf %15s", t->name, &t->period, &t->deadline, &t->wcet, t->kind) < 4
+			|| t->period <= 0 || t->deadline <= 0 || t->wcet < 0) {
+			fprintf(stderr, "linha invlida: %s", line);
+			fclose(f);
+			return -1;
+		}
+		t->deadline = t->deadline < t->period ? t->deadline : t->period;
+		n++;
+	}
+	fclose(f);
+	return n;
+}
+
+static double utilization(const struct Task* tasks, int n) {
+	double u = 0;
+
+	for (int i = 0; i < n; i++) {
+		u += tasks[i].wcet / tasks[i].period;
+	}
+	return u;
+}
+
+// Densidade: como a utilizao, mas dividindo pelo prazo
+static double density(const struct Task* tasks, int n) {
+	double d = 0;
+
+	for (int i = 0; i < n; i++) {
+		d += tasks[i].wcet / tasks[i].deadline;
+	}
+	return d;
+}
+
+// Ordens de prioridade: a primeira tarefa da ordem  a mais prioritria. Empates ficam com a
+// ordem do arquivo.
+static const struct Task* order_tasks;
+
+static int by_period(const void* p, const void* q) {
+	const struct Task* a = &order_tasks[*(const int*)p];
+	const struct Task* b = &order_tasks[*(const int*)q];
+
+	if (a->period != b->period) {
+		return a->period < b->period ? -1 : 1;
+	}
+	return *(const int*)p - *(const int*)q;
+}
+
+static int by_deadline(const void* p, const void* q) {
+	const struct Task* a = &order_tasks[*(const int*)p];
+	const struct Task* b = &order_tasks[*(const int*)q];
+
+	if (a->deadline != b->deadline) {
+		return a->deadline < b->deadline ? -1 : 1;
+	}
+	return *(const int*)p - *(const int*)q;
+}
+
+static void priority_order(const struct Task* tasks, int n, int (*compare)(const void*, const void*), int* order) {
+	for (int i = 0; i < n; i++) {
+		order[i] = i;
+	}
+	order_tasks = tasks;
+	qsort(order, (size_t)n, sizeof(int), compare);
+}
+
+// Funo que calcula o tempo de resposta de cada tarefa com prioridades fixas (anlise exata de
+// Joseph e Pandya): R = C + soma, sobre as mais prioritrias, de ceil(R / T) * C. Guarda em
+// response o tempo de cada tarefa (ou INFINITY se passar do prazo) e retorna 1 se todas cumprem.
+static int response_time_analysis(const struct Task* tasks, int n, const int* order, double scale, double* response) {
+	int schedulable = 1;
+
+	for (int k = 0; k < n; k++) {
+		const struct Task* t = &tasks[order[k]];
+		double r = t->wcet * scale, previous = -1;
+
+		while (r != previous && r <= t->deadline) {
+			previous = r;
+			r = t->wcet * scale;
+			for (int j = 0; j < k; j++) {
+				const struct Task* h = &tasks[order[j]];
+				r += ceil(previous / h->period) * h->wcet * scale;
+			}
+		}
+		if (r > t->deadline) {
+			r = INFINITY;
+			schedulable = 0;
+		}
+		if (response != NULL) {
+			response[order[k]] = r;
+		}
+	}
+	return schedulable;
+}
+
+// Funo que faz o teste exato do EDF. Com prazos iguais aos perodos basta U <= 1 (e com
+// densidade at 1 o conjunto tambm  escalonvel); seno verifica a demanda do processador h(t) <= t em cada prazo absoluto dentro do primeiro perodo
+// ocupado sncrono. Retorna 1 se escalonvel, 0 se no e -1 se o teste passou do limite de pontos.
+static int edf_test(const struct Task* tasks, int n) {
+	double u = utilization(tasks, n);
+	double busy = 0, previous = -1;
+	int implicit = 1, points = 0;
+
+	for (int i = 0; i < n; i++) {
+		implicit &= tasks[i].deadline >= tasks[i].period;
+		busy += tasks[i].wcet;
+	}
+	if (u > 1) {
+		return 0;
+	}
+	if (implicit || density(tasks, n) <= 1) {
+		return 1;
+	}
+	if (u == 1) {
+		// O perodo ocupado no termina; seria preciso verificar o hiperperodo inteiro
+		return -1;
+	}
+
+	// Comprimento do perodo ocupado sncrono: w = soma de ceil(w / T) * C
+	while (busy != previous) {
+		previous = busy;
+		busy = 0;
+		for (int i = 0; i < n; i++) {
+			busy += ceil(previous / tasks[i].period) * tasks[i].wcet;
+		}
+	}
+
+	// Percorre os prazos absolutos em ordem crescente
+	for (double t = 0; points < SCHED_MAX_DEMAND_POINTS; points++) {
+		double next = INFINITY, demand = 0;
+
+		for (int i = 0; i < n; i++) {
+			double k = t < tasks[i].deadline ? 0 : floor((t - tasks[i].deadline) / tasks[i].period) + 1;
+			double d = tasks[i].deadline + k * tasks[i].period;
+			next = d < next ? d : next;
+		}
+		if (next > busy) {
+			return 1;
+		}
+		t = next;
+		for (int i = 0; i < n; i++) {
+			if (t >= tasks[i].deadline) {
+				demand += (floor((t - tasks[i].deadline) / tasks[i].period) + 1) * tasks[i].wcet;
+			}
+		}
+		if (demand > t) {
+			return 0;
+		}
+	}
+	return -1;
+}
+
+// Funo que procura o maior fator pelo qual todos os WCET podem ser multiplicados sem perder
+// prazos na ordem dada (fator crtico de escala)
+static double critical_scale(const struct Task* tasks, int n, const int* order) {
+	double low = 0, high = 1;
+
+	while (response_time_analysis(tasks, n, order, high, NULL) && high < 1e9) {
+		low = high;
+		high *= 2;
+	}
+	for (int step = 0; step < SCHED_SEARCH_STEPS; step++) {
+		double mid = (low + high) / 2;
+
+		if (response_time_analysis(tasks, n, order, mid, NULL)) {
+			low = mid;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+// Funo que procura o menor perodo da tarefa i que mantm o conjunto escalonvel com
+// prioridades deadline-monotonic, com as outras tarefas fixas. O prazo acompanha o perodo
+// quando era igual a ele. Retorna o perodo atual se o conjunto j no  escalonvel.
+static double min_period(const struct Task* tasks, int n, int i) {
+	struct Task trial[SCHED_MAX_TASKS];
+	int order[SCHED_MAX_TASKS];
+	int implicit = tasks[i].deadline >= tasks[i].period;
+	double low = tasks[i].wcet, high = tasks[i].period;
+
+	memcpy(trial, tasks, (size_t)n * sizeof(struct Task));
+	for (int step = 0; step < SCHED_SEARCH_STEPS; step++) {
+		double mid = (low + high) / 2;
+
+		trial[i].period = mid;
+		trial[i].deadline = implicit || tasks[i].deadline > mid ? mid : tasks[i].deadline;
+		priority_order(trial, n, by_deadline, order);
+		if (response_time_analysis(trial, n, order, 1, NULL)) {
+			high = mid;
+		}
+		else {
+			low = mid;
+		}
+	}
+	return high;
+}
+
+static void print_analysis(const char* name, const struct Task* tasks, int n, const int* order) {
+	double response[SCHED_MAX_TASKS];
+	int ok = response_time_analysis(tasks, n, order, 1, response);
+
+	printf("\n%s: %s\n", name, ok ? "escalonvel" : "NO escalonvel");
+	for (int k = 0; k < n; k++) {
+		const struct Task* t = &tasks[order[k]];
+		printf("  %2d %-16s R = %12.1f us  (prazo %12.1f us)%s\n", n - k, t->name, response[order[k]], t->deadline,
+			isinf(response[order[k]]) ? "  perde o prazo" : "");
+	}
+	if (ok) {
+		printf("  Os WCET podem crescer at %.2f vezes\n", critical_scale(tasks, n, order));
+	}
+}
+
+// Funo que grava o cabealho com as prioridades deadline-monotonic
+static int write_config(const char* path, const struct Task* tasks, int n, const int* order) {
+	FILE* f = fopen(path, "w");
+
+	if (f == NULL) {
+		fprintf(stderr, "no foi possvel criar %s\n", path);
+		return -1;
+	}
+	fprintf(f, "#ifndef TASK_CONFIG_H\n#define TASK_CONFIG_H\n\n");
+	fprintf(f, "// Gerado por tools/schedcheck.c: prioridades deadline-monotonic das tarefas\n\n");
+	for (int k = 0; k < n; k++) {
+		const struct Task* t = &tasks[order[k]];
+
+		fprintf(f, "#define TASK_");
+		for (const char* c = t->name; *c != '\0'; c++) {
+			fputc(isalnum((unsigned char)*c) ? toupper((unsigned char)*c) : '_', f);
+		}
+		fprintf(f, "_PRIORITY %d // Perodo %.1f us, prazo %.1f us, WCET %.1f us\n",
+			SCHED_BASE_PRIORITY + n - 1 - k, t->period, t->deadline, t->wcet);
+	}
+	fprintf(f, "\n#endif\n");
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+	struct Task tasks[SCHED_MAX_TASKS];
+	int rm[SCHED_MAX_TASKS], dm[SCHED_MAX_TASKS];
+	double u, hyperbolic = 1;
+	int n, edf;
+
+	if (argc < 2) {
+		fprintf(stderr, "uso: %s tarefas.txt [task_config.h]\n", argv[0]);
+		return 1;
+	}
+	n = read_tasks(argv[1], tasks);
+	if (n <= 0) {
+		return 1;
+	}
+
+	u = utilization(tasks, n);
+	printf("%-16s %12s %12s %12s %8s  %s\n", "tarefa", "perodo us", "prazo us", "WCET us", "U", "liberao");
+	for (int i = 0; i < n; i++) {
+		printf("%-16s %12.1f %12.1f %12.1f %8.4f  %s\n", tasks[i].name, tasks[i].period, tasks[i].deadline, tasks[i].wcet,
+			tasks[i].wcet / tasks[i].period, tasks[i].kind);
+		hyperbolic *= tasks[i].wcet / tasks[i].period + 1;
+	}
+	printf("Utilizao %.4f; limite de Liu e Layland %.4f; limite hiperblico %s\n", u, n * (pow(2.0, 1.0 / n) - 1),
+		hyperbolic <= 2 ? "respeitado" : "no respeitado");
+
+	priority_order(tasks, n, by_period, rm);
+	priority_order(tasks, n, by_deadline, dm);
+	print_analysis("Rate-monotonic", tasks, n, rm);
+	print_analysis("Deadline-monotonic", tasks, n, dm);
+
+	edf = edf_test(tasks, n);
+	printf("\nEDF: %s (utilizao %.4f, densidade %.4f)\n",
+		edf > 0 ? "escalonvel" : edf == 0 ? "NO escalonvel" : "inconclusivo", u, density(tasks, n));
+
+	// Recomendaes: prioridades deadline-monotonic (timas entre as fixas com prazo <= perodo)
+	// e o menor perodo de cada tarefa com as outras fixas
+	printf("\nRecomendao (deadline-monotonic, prioridade maior = mais urgente):\n");
+	for (int k = 0; k < n; k++) {
+		const struct Task* t = &tasks[dm[k]];
+		printf("  %-16s prioridade %d, perodo mnimo %12.1f us (atual %12.1f us)\n", t->name, SCHED_BASE_PRIORITY + n - 1 - k,
+			min_period(tasks, n, dm[k]), t->period);
+	}
+
+	if (argc > 2) {
+		if (write_config(argv[2], tasks, n, dm) != 0) {
+			return 1;
+		}
+		printf("\nPrioridades gravadas em %s\n", argv[2]);
+	}
+	return 0;
+}